@@ -0,0 +1,394 @@
+/**
+ * @file
+ * @brief Times the engine's hot primitives one at a time on a fixed corpus of positions.
+ *
+ * makeMove+unMakeMove and makeMove+restore(Position) compare make/unmake with copy-make.
+ *
+ * Usage: microbench [--repeats <N>] [--filter <text>] [--output <file.json>]
+ *                   [--baseline <file.json>] [--threshold <percent>]
+ *
+ * Every primitive is warmed up, then timed over --repeats samples. A sample repeats a sweep over
+ * the whole corpus until it has run for at least minSampleTime, so short primitives are not lost
+ * in clock resolution. The mean, standard deviation and minimum ns/op of the samples are reported.
+ * --output saves the results as JSON; --baseline compares against such a file and exits non zero
+ * if any primitive got slower than --threshold percent (default 5).
+ */
+#include "board/board.hpp"
+#include "board/fen.hpp"
+#include "evaluation/evaluation.hpp"
+#include "moves/generation/move_generation.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Opening, middlegame and endgame positions, with castling, en passant and promotions
+const std::vector<std::string> corpus = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "rnbqkb1r/pp1p1ppp/4pn2/2pP4/2P5/8/PP2PPPP/RNBQKBNR w KQkq c6 0 4",
+    "2r3k1/1q3ppp/p3p3/1p1nP3/3P4/P2Q1N2/1P3PPP/2R3K1 b - - 3 24",
+    "8/8/4k3/3pP3/3K4/8/8/8 w - d6 0 50",
+    "8/1P4k1/8/8/8/8/6Kp/8 b - - 0 60",
+};
+
+constexpr int warmupSweeps = 3;
+constexpr auto minSampleTime = std::chrono::milliseconds(20);
+
+/**
+ * @brief One timed primitive. sweep runs it over the whole corpus once and returns the number of
+ * operations it performed; checksum collects results so the work cannot be optimized away.
+ */
+struct Primitive {
+    std::string name;
+    std::function<uint64_t(uint64_t& checksum)> sweep;
+};
+
+struct Measurement {
+    std::string name;
+    double meanNs;
+    double stddevNs;
+    double minNs;
+    std::size_t samples;
+};
+
+std::vector<Primitive> makePrimitives(std::vector<Board>& boards) {
+    std::vector<Primitive> primitives;
+
+    // Moves are generated up front so only makeMove/unMakeMove are timed
+    std::vector<MoveList> legalMoves;
+    for (auto& board : boards) legalMoves.push_back(board.generateLegalMoves());
+
+    primitives.push_back({"makeMove+unMakeMove", [&boards, legalMoves](uint64_t& checksum) {
+                              uint64_t ops = 0;
+                              for (std::size_t i = 0; i < boards.size(); ++i) {
+                                  auto& board = boards[i];
+                                  for (const auto& move : legalMoves[i]) {
+                                      board.makeMove(move);
+                                      checksum += board.zobristKey;
+                                      board.unMakeMove(move);
+                                      ++ops;
+                                  }
+                              }
+                              return ops;
+                          }});
+
+    // The copy-make alternative: save the trivially copyable Position, play, restore the copy
+    primitives.push_back({"makeMove+restore(Position)", [&boards, legalMoves](uint64_t& checksum) {
+                              uint64_t ops = 0;
+                              for (std::size_t i = 0; i < boards.size(); ++i) {
+                                  auto& board = boards[i];
+                                  const Position saved = board;
+                                  for (const auto& move : legalMoves[i]) {
+                                      board.makeMove(move);
+                                      checksum += board.zobristKey;
+                                      board.restore(saved);
+                                      ++ops;
+                                  }
+                              }
+                              return ops;
+                          }});
+
+    primitives.push_back({"getPieceAt", [&boards](uint64_t& checksum) {
+                              uint64_t ops = 0;
+                              for (const auto& board : boards) {
+                                  for (int square = 0; square < 64; ++square) {
+                                      const auto piece = board.getPieceAt(Square(square));
+                                      checksum += static_cast<uint64_t>(piece.type);
+                                      ++ops;
+                                  }
+                              }
+                              return ops;
+                          }});
+
+    primitives.push_back({"Board::isSquareAttacked", [&boards](uint64_t& checksum) {
+                              uint64_t ops = 0;
+                              for (const auto& board : boards) {
+                                  for (int square = 0; square < 64; ++square) {
+                                      const Square target(square);
+                                      checksum += board.isSquareAttacked(target, Side::White);
+                                      checksum += board.isSquareAttacked(target, Side::Black);
+                                      ops += 2;
+                                  }
+                              }
+                              return ops;
+                          }});
+
+    primitives.push_back({"MoveGenerator::isSquareAttacked", [&boards](uint64_t& checksum) {
+                              uint64_t ops = 0;
+                              for (auto& board : boards) {
+                                  const MoveGenerator generator(board);
+                                  for (int square = 0; square < 64; ++square) {
+                                      checksum += generator.isSquareAttacked(Square(square),
+                                                                             Side::White);
+                                      checksum += generator.isSquareAttacked(Square(square),
+                                                                             Side::Black);
+                                      ops += 2;
+                                  }
+                              }
+                              return ops;
+                          }});
+
+    // Static exchange evaluation of every legal move (captures and quiet moves alike)
+    primitives.push_back({"Board::see", [&boards, legalMoves](uint64_t& checksum) {
+                              uint64_t ops = 0;
+                              for (std::size_t i = 0; i < boards.size(); ++i) {
+                                  for (const auto& move : legalMoves[i]) {
+                                      checksum += boards[i].see(move);
+                                      ++ops;
+                                  }
+                              }
+                              return ops;
+                          }});
+
+    primitives.push_back({"Board::seeGE", [&boards, legalMoves](uint64_t& checksum) {
+                              uint64_t ops = 0;
+                              for (std::size_t i = 0; i < boards.size(); ++i) {
+                                  for (const auto& move : legalMoves[i]) {
+                                      checksum += boards[i].seeGE(move);
+                                      ++ops;
+                                  }
+                              }
+                              return ops;
+                          }});
+
+    primitives.push_back({"generatePseudoLegalMoves", [&boards](uint64_t& checksum) {
+                              uint64_t ops = 0;
+                              for (auto& board : boards) {
+                                  MoveGenerator generator(board);
+                                  checksum += generator.generatePseudoLegalMoves().size();
+                                  ++ops;
+                              }
+                              return ops;
+                          }});
+
+    primitives.push_back({"generateMoves", [&boards](uint64_t& checksum) {
+                              uint64_t ops = 0;
+                              for (auto& board : boards) {
+                                  MoveGenerator generator(board);
+                                  checksum += generator.generateMoves().size();
+                                  ++ops;
+                              }
+                              return ops;
+                          }});
+
+    primitives.push_back({"Evaluation::evaluate", [&boards](uint64_t& checksum) {
+                              uint64_t ops = 0;
+                              for (const auto& board : boards) {
+                                  checksum += Evaluation::evaluate(board);
+                                  ++ops;
+                              }
+                              return ops;
+                          }});
+
+    // Each evaluateComponents term on its own: material, piece squares, pawns, king safety
+    const std::array<std::string, 4> terms = {"material", "pieceSquares", "pawnStructure",
+                                              "kingSafety"};
+    for (std::size_t term = 0; term < terms.size(); ++term) {
+        primitives.push_back({"evaluateComponents(" + terms[term] + ")",
+                              [&boards, term](uint64_t& checksum) {
+                                  uint64_t ops = 0;
+                                  for (const auto& board : boards) {
+                                      checksum += Evaluation::evaluateComponents(
+                                          board, term == 0, term == 1, term == 2, term == 3);
+                                      ++ops;
+                                  }
+                                  return ops;
+                              }});
+    }
+
+    primitives.push_back({"FEN::parse", [](uint64_t& checksum) {
+                              uint64_t ops = 0;
+                              Board board;
+                              for (const auto& fen : corpus) {
+                                  FEN::parse(fen, board);
+                                  checksum += board.zobristKey;
+                                  ++ops;
+                              }
+                              return ops;
+                          }});
+
+    primitives.push_back({"FEN::generate", [&boards](uint64_t& checksum) {
+                              uint64_t ops = 0;
+                              for (const auto& board : boards) {
+                                  checksum += FEN::generate(board).size();
+                                  ++ops;
+                              }
+                              return ops;
+                          }});
+
+    return primitives;
+}
+
+Measurement measure(const Primitive& primitive, std::size_t repeats, uint64_t& checksum) {
+    for (int i = 0; i < warmupSweeps; ++i) primitive.sweep(checksum);
+
+    std::vector<double> samples;
+    samples.reserve(repeats);
+    for (std::size_t sample = 0; sample < repeats; ++sample) {
+        uint64_t ops = 0;
+        const auto start = Clock::now();
+        auto elapsed = Clock::duration::zero();
+        while (elapsed < minSampleTime) {
+            ops += primitive.sweep(checksum);
+            elapsed = Clock::now() - start;
+        }
+        samples.push_back(std::chrono::duration<double, std::nano>(elapsed).count() /
+                          static_cast<double>(ops));
+    }
+
+    double mean = 0;
+    for (const auto sample : samples) mean += sample;
+    mean /= static_cast<double>(samples.size());
+    double variance = 0;
+    for (const auto sample : samples) variance += (sample - mean) * (sample - mean);
+    variance /= static_cast<double>(samples.size() > 1 ? samples.size() - 1 : 1);
+
+    return {primitive.name, mean, std::sqrt(variance),
+            *std::min_element(samples.begin(), samples.end()), samples.size()};
+}
+
+void writeJson(std::ostream& output, const std::vector<Measurement>& measurements) {
+    output << std::fixed << std::setprecision(3) << "{\n  \"results\": [\n";
+    for (std::size_t i = 0; i < measurements.size(); ++i) {
+        const auto& m = measurements[i];
+        output << "    {\"name\": \"" << m.name << "\", \"mean_ns\": " << m.meanNs
+               << ", \"stddev_ns\": " << m.stddevNs << ", \"min_ns\": " << m.minNs
+               << ", \"samples\": " << m.samples << "}"
+               << (i + 1 < measurements.size() ? "," : "") << "\n";
+    }
+    output << "  ]\n}\n";
+}
+
+/**
+ * @brief Reads the mean ns/op of every primitive from a file written by writeJson
+ *
+ * Only understands the layout writeJson produces (one result object per line), which is all a
+ * saved baseline ever contains.
+ */
+std::map<std::string, double> readBaseline(std::istream& input) {
+    std::map<std::string, double> baseline;
+    std::string line;
+    const std::string nameKey = "\"name\": \"", meanKey = "\"mean_ns\": ";
+    while (std::getline(input, line)) {
+        const auto namePos = line.find(nameKey);
+        const auto meanPos = line.find(meanKey);
+        if (namePos == std::string::npos || meanPos == std::string::npos) continue;
+        const auto nameStart = namePos + nameKey.size();
+        const auto name = line.substr(nameStart, line.find('"', nameStart) - nameStart);
+        baseline[name] = std::strtod(line.c_str() + meanPos + meanKey.size(), nullptr);
+    }
+    return baseline;
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program
+              << " [--repeats <N>] [--filter <text>] [--output <file.json>]"
+                 " [--baseline <file.json>] [--threshold <percent>]\n";
+    std::cerr << "Example: " << program << " --output bench/microbench_baseline.json\n";
+    std::cerr << "Example: " << program << " --baseline bench/microbench_baseline.json\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::size_t repeats = 10;
+    std::string filter, outputPath, baselinePath;
+    double threshold = 5.0;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const auto hasValue = i + 1 < argc;
+        if (arg == "--repeats" && hasValue) {
+            repeats = std::max<std::size_t>(std::strtoull(argv[++i], nullptr, 10), 1);
+        } else if (arg == "--filter" && hasValue) {
+            filter = argv[++i];
+        } else if (arg == "--output" && hasValue) {
+            outputPath = argv[++i];
+        } else if (arg == "--baseline" && hasValue) {
+            baselinePath = argv[++i];
+        } else if (arg == "--threshold" && hasValue) {
+            threshold = std::strtod(argv[++i], nullptr);
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::map<std::string, double> baseline;
+    if (!baselinePath.empty()) {
+        std::ifstream input(baselinePath);
+        if (!input) {
+            std::cerr << "Error: Cannot open baseline " << baselinePath << "\n";
+            return 1;
+        }
+        baseline = readBaseline(input);
+    }
+
+    std::vector<Board> boards;
+    for (const auto& fen : corpus) boards.emplace_back(fen);
+
+    std::cout << "Corpus: " << corpus.size() << " positions, " << repeats
+              << " samples per primitive\n\n";
+    std::cout << std::left << std::setw(36) << "primitive" << std::right << std::setw(12)
+              << "ns/op" << std::setw(12) << "stddev" << std::setw(12) << "min"
+              << (baseline.empty() ? "" : "    baseline   change") << "\n";
+
+    uint64_t checksum = 0;
+    std::vector<Measurement> measurements;
+    std::size_t regressions = 0;
+    for (const auto& primitive : makePrimitives(boards)) {
+        if (!filter.empty() && primitive.name.find(filter) == std::string::npos) continue;
+        const auto m = measure(primitive, repeats, checksum);
+        measurements.push_back(m);
+
+        std::cout << std::left << std::setw(36) << m.name << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(12) << m.meanNs << std::setw(12)
+                  << m.stddevNs << std::setw(12) << m.minNs;
+        const auto reference = baseline.find(m.name);
+        if (reference != baseline.end() && reference->second > 0) {
+            const auto change = (m.meanNs / reference->second - 1.0) * 100.0;
+            const auto regressed = change > threshold;
+            if (regressed) ++regressions;
+            std::cout << std::setw(12) << reference->second << std::showpos << std::setw(8)
+                      << std::setprecision(1) << change << "%" << std::noshowpos
+                      << (regressed ? "  REGRESSION" : "");
+        }
+        std::cout << "\n";
+    }
+    // Printing the checksum keeps every result observable
+    std::cout << "\nChecksum: " << checksum << "\n";
+
+    if (!outputPath.empty()) {
+        std::ofstream output(outputPath);
+        if (!output) {
+            std::cerr << "Error: Cannot write " << outputPath << "\n";
+            return 1;
+        }
+        writeJson(output, measurements);
+        std::cout << "Results written to " << outputPath << "\n";
+    }
+
+    if (!baseline.empty()) {
+        std::cout << regressions << " primitive(s) slower than the baseline by more than "
+                  << threshold << "%\n";
+    }
+    return regressions == 0 ? 0 : 1;
+}
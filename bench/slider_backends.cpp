@@ -0,0 +1,107 @@
+/**
+ * @file
+ * @brief Compares the slider attack backends (magic vs PEXT) on raw lookups and on the standard
+ * perft positions.
+ *
+ * Usage: slider_bench [depth offset]
+ * The optional argument is added to the default depth of every position.
+ */
+#include "board/board.hpp"
+#include "moves/generation/attack_squares.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct PerftPosition {
+    std::string name;
+    std::string fen;
+    int depth;
+};
+
+const std::vector<PerftPosition> perftSuite = {
+    {"startpos", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 5},
+    {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4},
+    {"pos3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5},
+    {"pos4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4},
+    {"pos5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4},
+};
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Average ns per rook + bishop lookup over a fixed set of random occupancies. checksum combines
+// every result, it is printed so the loop is not optimised away and must match between backends.
+double benchLookups(uint64_t& checksum) {
+    std::mt19937_64 rng(2024);
+    std::vector<BitBoard> occupancies(4096);
+    for (auto& occupancy : occupancies) occupancy = BitBoard(rng() & rng());
+
+    constexpr int rounds = 64;
+    checksum = 0;
+    const auto start = Clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        for (const auto occupancy : occupancies) {
+            for (int square = 0; square < 64; ++square) {
+                checksum += AttackTables::rookAttacks(square, occupancy);
+                checksum += AttackTables::bishopAttacks(square, occupancy);
+            }
+        }
+    }
+    const auto elapsed = secondsSince(start);
+    return elapsed * 1e9 / (rounds * occupancies.size() * 64.0 * 2);
+}
+
+void runBackend(AttackTables::SliderBackend backend, int depthOffset) {
+    AttackTables::setSliderBackend(backend);
+    std::cout << "\n=== Backend: " << AttackTables::sliderBackendName(backend) << " ===\n";
+    uint64_t checksum = 0;
+    const auto lookup = benchLookups(checksum);
+    std::cout << "Lookup: " << std::fixed << std::setprecision(2) << lookup
+              << " ns/lookup (checksum " << std::hex << checksum << std::dec << ")\n";
+
+    uint64_t totalNodes = 0;
+    double totalSeconds = 0;
+    for (const auto& position : perftSuite) {
+        Board board(position.fen);
+        const auto depth = position.depth + depthOffset;
+        const auto start = Clock::now();
+        // Full make/unmake so every node pays for its move generation lookups
+        const auto nodes = board.perft(depth, false, Board::PerftMode::MakeUnmake);
+        const auto seconds = secondsSince(start);
+        totalNodes += nodes;
+        totalSeconds += seconds;
+        std::cout << std::left << std::setw(10) << position.name << " depth " << depth
+                  << std::right << std::setw(12) << nodes << " nodes " << std::setw(10)
+                  << std::setprecision(1) << seconds * 1000 << " ms " << std::setw(12)
+                  << std::setprecision(0) << nodes / seconds << " nps\n";
+    }
+    std::cout << "Total: " << totalNodes << " nodes in " << std::setprecision(1)
+              << totalSeconds * 1000 << " ms, " << std::setprecision(0)
+              << totalNodes / totalSeconds << " nps\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const auto depthOffset = argc > 1 ? std::atoi(argv[1]) : 0;
+    const auto detected = AttackTables::detectSliderBackend();
+    std::cout << "Detected backend: " << AttackTables::sliderBackendName(detected) << "\n";
+
+    runBackend(AttackTables::SliderBackend::Magic, depthOffset);
+    if (AttackTables::cpuSupportsBmi2()) {
+        runBackend(AttackTables::SliderBackend::Pext, depthOffset);
+    } else {
+        std::cout << "\nCPU has no BMI2, skipping the PEXT backend\n";
+    }
+    return 0;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file
+ * @brief Time to depth of the parallel searches at 1, 2, 4, ... threads.
+ *
+ * Usage: smp_bench [--depth <N>] [--max-threads <N>] [--hash <MB>]
+ *
+ * The bench positions are searched to the same depth with an empty table, once on one thread and
+ * then in each parallel mode (Lazy SMP and split points) at every thread count. The speedup is the
+ * one thread time over the N thread time, summed over the positions; the overhead is how many more
+ * nodes than the one thread search it took, work that a faster search has to make up for.
+ * Defaults: depth 7, as many threads as the machine has, 64 MB.
+ */
+#include "board/board.hpp"
+#include "moves/search/search.hpp"
+#include "moves/search/transposition_table.hpp"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// The positions of `schmetterling_exec bench`
+const std::vector<std::string> positions = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+};
+
+struct Totals {
+    double seconds = 0;
+    uint64_t nodes = 0;
+};
+
+Totals searchAll(TranspositionTable& table, int depth, std::size_t threads, ParallelMode mode) {
+    Totals totals;
+    for (const auto& fen : positions) {
+        Board board(fen);
+        table.clear();
+        const auto result = Search(board, &table, threads, mode).run({.depth = depth});
+        totals.seconds += result.seconds;
+        totals.nodes += result.nodes;
+    }
+    return totals;
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--depth <N>] [--max-threads <N>] [--hash <MB>]\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int depth = 7;
+    std::size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::size_t hashMegabytes = 64;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg != "--depth" && arg != "--max-threads" && arg != "--hash") {
+            std::cerr << "Error: Unknown argument " << arg << "\n";
+            printUsage(argv[0]);
+            return 1;
+        }
+        if (i + 1 == argc) {
+            std::cerr << "Error: " << arg << " needs a value\n";
+            printUsage(argv[0]);
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (arg == "--depth") {
+            depth = std::atoi(value);
+        } else if (arg == "--max-threads") {
+            maxThreads = std::strtoull(value, nullptr, 10);
+        } else {
+            hashMegabytes = std::strtoull(value, nullptr, 10);
+        }
+    }
+    if (depth <= 0 || maxThreads == 0) {
+        std::cerr << "Error: --depth and --max-threads must be positive\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::vector<std::size_t> threadCounts;
+    for (std::size_t threads = 2; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    if (maxThreads > 1) threadCounts.push_back(maxThreads);
+
+    std::cout << "Time to depth " << depth << " on " << positions.size() << " positions, "
+              << hashMegabytes << " MB table\n\n";
+    std::cout << std::left << std::setw(14) << "mode" << std::setw(10) << "threads" << std::right
+              << std::setw(12) << "time (ms)" << std::setw(10) << "speedup" << std::setw(14)
+              << "nodes" << std::setw(11) << "overhead" << std::setw(12) << "nps" << "\n";
+
+    TranspositionTable table(hashMegabytes);
+    const auto serial = searchAll(table, depth, 1, ParallelMode::LazySmp);
+    const auto print = [&](const char* mode, std::size_t threads, const Totals& totals) {
+        const auto overhead = 100.0 * (static_cast<double>(totals.nodes) / serial.nodes - 1);
+        std::cout << std::left << std::setw(14) << mode << std::setw(10) << threads << std::right
+                  << std::fixed << std::setprecision(0) << std::setw(12) << totals.seconds * 1000
+                  << std::setw(10) << std::setprecision(2) << serial.seconds / totals.seconds
+                  << std::setw(14) << totals.nodes << std::setw(10) << std::setprecision(1)
+                  << overhead << "%" << std::setw(12) << std::setprecision(0)
+                  << totals.nodes / totals.seconds << "\n";
+    };
+    print("serial", 1, serial);
+
+    const std::pair<const char*, ParallelMode> modes[] = {
+        {"lazy-smp", ParallelMode::LazySmp}, {"split-points", ParallelMode::SplitPoints}};
+    for (const auto& [name, mode] : modes) {
+        for (const auto threads : threadCounts) {
+            print(name, threads, searchAll(table, depth, threads, mode));
+        }
+    }
+    return 0;
+}
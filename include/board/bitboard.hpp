@@ -17,7 +17,7 @@ class BitBoard {
 
     // Conversion to raw bitboard
     inline constexpr operator uint64_t() const { return _bits; }
-    inline constexpr operator std::string() const { return this->createDiagram(); }
+    inline operator std::string() const { return this->createDiagram(); }
 
     // Bitwise operators
     inline constexpr BitBoard operator&(BitBoard other) const {
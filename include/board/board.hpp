@@ -5,15 +5,19 @@
 
 #pragma once
 
+#include "../moves/move_list.hpp"
 #include "../moves/moves.hpp"
 #include "bitboard.hpp"
 #include "fen.hpp"
+#include "perft_table.hpp"
+#include "moves/generation/attack_squares.hpp"
 #include "moves/generation/move_generation.hpp"
 
 #include <array>
 #include <cstdint>
 #include <optional>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 // BitBoard bishops = currentState.piecesBitBoards[base + static_cast<int>(PieceType::Bishop)];
@@ -22,6 +26,9 @@ struct BoardState {
     std::array<BitBoard, 2> colorBitBoards;   // One for each color
     std::array<BitBoard, 2> diagonalSliders;  // Bishops + Queens (White, Black)
     std::array<BitBoard, 2> orthoSliders;     // Rooks + Queens (White, Black)
+    std::array<uint8_t, 64> mailbox; // Piece index (as in piecesBitBoards) on each square
+
+    static constexpr uint8_t noPiece = 12; // Mailbox value of an empty square
 };
 
 struct BoardHistory {
@@ -35,24 +42,38 @@ struct BoardHistory {
     Move lastMove;
 };
 
-// TODO: Implement a tryMove function that does not affect global state ??????
-class Board {
-  public:
-    static const std::string startPositionFen;
-
+/**
+ * @brief Everything that describes a position, without any heap storage
+ *
+ * Trivially copyable, so saving a position is a plain memcpy of four cache lines. Copy-make code
+ * (PerftMode::CopyMake) keeps one per ply on the stack and restores it instead of calling
+ * unMakeMove. Members are ordered largest first so the padding stays in the last line.
+ */
+struct alignas(64) Position {
     BoardState currentState; // Current Board
 
-    Side side; /// Side to move, 0 - white, 1 - black
-
-    uint8_t castlingRights; // Castling rights (bitmask: WhiteKingside | WhiteQueenside |
-                            // BlackKingside | BlackQueenside);
+    // Zobrist key of the position (pieces, side to move, castling rights, en passant file). Kept up
+    // to date incrementally by every function that changes one of these.
+    uint64_t zobristKey;
     std::optional<Square> enPassantSquare;
     // Number of halfmoves wrt to the fiftyMove draw rule. It is reset at a pawn move or a capture
     // move and incremented otherwise
     int halfMoveClock;
     // Number of fullmoves in the game, starts at 1 and is incremented after blacks move
     int fullMoveClock;
-    bool inCheckCache;
+
+    Side side; /// Side to move, 0 - white, 1 - black
+
+    uint8_t castlingRights; // Castling rights (bitmask: WhiteKingside | WhiteQueenside |
+                            // BlackKingside | BlackQueenside);
+};
+static_assert(std::is_trivially_copyable_v<Position>, "Position must stay memcpy-able");
+static_assert(sizeof(Position) == 256, "Position grew past four cache lines");
+
+// TODO: Implement a tryMove function that does not affect global state ??????
+class Board : public Position {
+  public:
+    static const std::string startPositionFen;
 
     // ANSI color codes for the diagram
     static constexpr std::string RESET = "\033[0m";
@@ -63,17 +84,28 @@ class Board {
     static constexpr std::string HIGHLIGHT_BG =
         "\033[1;48;5;220m"; // Bright yellow highlight (#ffd700)
 
+    /**
+     * @brief What makeMove cannot recompute when the move is taken back, packed into 16 bytes
+     *
+     * The moved piece is not stored: unMakeMove finds it on the target square (a pawn, if the
+     * move is a promotion). The key is restored as a whole instead of being xored back.
+     */
     struct UndoInfo {
-        Square from;
-        Square to;
-        Piece movedPiece;
-        std::optional<Piece> capturedPiece;
-        std::optional<PieceType> promotion;
-        std::optional<Square> previousEnPassantSquare;
+        uint64_t previousKey;
+        Move move;                      ///< Move(0) for a null move
+        uint16_t previousHalfmoveClock;
+        uint8_t capturedPiece;          ///< Mailbox value, BoardState::noPiece if nothing
         uint8_t previousCastlingRights;
-        int previousHalfmoveClock;
+        uint8_t previousEnPassantFile;  ///< noEnPassantFile if there was no en passant square
     };
-    std::vector<UndoInfo> undoHistory;
+    static_assert(sizeof(UndoInfo) <= 16, "UndoInfo must stay within 16 bytes");
+    static constexpr uint8_t noEnPassantFile = 8;
+
+    // Undo records of the moves played so far, the top one belongs to the last move. Fixed size so
+    // making a move never allocates; a longer game than this throws std::length_error.
+    static constexpr std::size_t maxPly = 1024;
+    std::array<UndoInfo, maxPly> undoStack;
+    std::size_t undoCount = 0;
 
     static constexpr int whiteKingside = 0b0001;
     static constexpr int whiteQueenside = 0b0010;
@@ -84,6 +116,7 @@ class Board {
         // Initialise Empty bitboard;
         currentState.colorBitBoards.fill(BitBoard());
         currentState.piecesBitBoards.fill(BitBoard());
+        currentState.mailbox.fill(BoardState::noPiece);
         side = Side::White;
         castlingRights = whiteKingside | whiteQueenside | blackKingside | blackQueenside;
         enPassantSquare = std::nullopt;
@@ -91,40 +124,220 @@ class Board {
         fullMoveClock = 1;
 
         updateSliderBitboards();
+        zobristKey = computeZobristKey();
     }
 
     Board(std::string fen) { FEN::parse(fen, *this); }
     std::string toFEN() const { return FEN::generate(*this); }
 
-    inline constexpr operator std::string() { return Board::createDiagram(*this); }
+    inline operator std::string() { return Board::createDiagram(*this); }
     Piece getPieceAt(const Square s) const;
     Piece getPieceAt(const std::string squareName) const;
 
-    UndoInfo makeMove(const Square from, const Square to);
-    void unMakeMove(const Square from, const Square to, const UndoInfo& undoInfo);
+    /**
+     * @brief Plays a move as generated, trusting its MoveFlag for castling, en passant, double
+     * pushes and the promotion piece instead of looking at the squares
+     */
+    void makeMove(const Move move);
+    /**
+     * @brief Plays a move given by its squares (user input, tests), see flaggedMove()
+     */
+    void makeMove(const Square from, const Square to, const PieceType promotion = PieceType::None);
+    /**
+     * @brief Builds the Move, flag included, that moves the piece on from to to in this position
+     */
+    Move flaggedMove(const Square from, const Square to,
+                     const PieceType promotion = PieceType::None) const;
+    /**
+     * @brief Takes back the last makeMove, using the record on top of the undo stack
+     * @param move The move that was played. Only its squares are checked (in debug builds), the
+     * flags come from the record.
+     */
+    void unMakeMove(const Move move);
     void movePiece(const Piece movedPiece, const int startSquareIndex, const int targetSquareIndex);
+    void putPiece(const Piece piece, const Square square);
+    void removePiece(const Piece piece, const Square square);
+    /**
+     * @brief Takes back the last makeMove by restoring the Position saved before it, the copy-make
+     * alternative to unMakeMove
+     */
+    void restore(const Position& saved);
+    /**
+     * @brief Takes over another board's position and the undo records of only its last moves,
+     * as many as still matter for repetitions (halfMoveClock), without copying the whole stack.
+     * The moves before those cannot be taken back on this board.
+     */
+    void copyRecent(const Board& other);
     void makeNullMove();
-    void unmakeNullMove(const UndoInfo& undoInfo);
+    void unmakeNullMove();
     /**
      * @brief Checks if the current player is in check
-     * Note: caches check value so calling multiple
-     * times does not require recalculating
+     * Note: reads checkers(), so calling it multiple times per position does not recalculate
      * @return  true if the current player is in check
      */
-    bool isInCheck();
-    bool calculateInCheckState() const;
+    bool isInCheck() const { return !checkers().isEmpty(); }
+    bool calculateInCheckState() const { return isInCheck(); }
+
+    /**
+     * @brief Enemy pieces giving check to the side to move
+     */
+    BitBoard checkers() const { return checkInfo().checkers; }
+    /**
+     * @brief Pieces of either side that are the only piece between a slider and the king of
+     * kingSide. Ours are pinned, theirs would give a discovered check by moving away.
+     */
+    BitBoard blockersForKing(Side kingSide) const {
+        return checkInfo().blockersForKing[kingSide];
+    }
+    /**
+     * @brief Sliders of pinnerSide that pin a piece of the other side to its king
+     */
+    BitBoard pinners(Side pinnerSide) const { return checkInfo().pinners[pinnerSide]; }
+
+    BitBoard occupancy() const {
+        return currentState.colorBitBoards[Side::White] | currentState.colorBitBoards[Side::Black];
+    }
+
+    /**
+     * @brief All pieces of both sides that attack a square. The occupancy only decides which
+     * slider rays are blocked, so passing a modified one answers "would this square be attacked
+     * if ...". Every attack query (check and pin detection, king safety, castling, SEE) ends up
+     * here.
+     */
+    BitBoard attackersTo(int squareIndex, BitBoard occupancy) const;
+    /**
+     * @brief attackersTo() restricted to the pieces of Attacker
+     */
+    template <Side::Value Attacker> BitBoard attackersTo(int squareIndex, BitBoard occupancy) const;
     void updateSliderBitboards();
+    /**
+     * @brief The last move played, Move(0) if there is none (or it was a null move)
+     */
+    Move lastMove() const { return undoCount ? undoStack[undoCount - 1].move : Move(0); }
+    /**
+     * @brief Debug check that the mailbox and the piece/color bitboards describe the same position
+     * @return true if every square agrees
+     */
+    bool isConsistent() const;
+    /**
+     * @brief Computes the Zobrist key of the position from scratch
+     */
+    uint64_t computeZobristKey() const;
+    void toggleStateKey();
 
     static const std::string createDiagram(const Board& board, const bool blackAtTop = true,
                                            bool const includeFen = true);
 
     Board& operator=(const Board&) = default;
 
-    std::vector<Move> generateLegalMoves();
+    MoveList generateLegalMoves();
 
     Square findKingSquare(Side side) const;
+    /**
+     * @brief Whether any piece of the attacking side attacks the square, see attackersTo()
+     */
     bool isSquareAttacked(Square square, Side attackerSide) const;
+    template <Side::Value Attacker> bool isSquareAttacked(Square square) const;
 
-    uint64_t perft(int depth, bool verbose = false);
-    void perftDivide(int depth);
+    /**
+     * @brief Static exchange evaluation of a legal move: the material the side to move ends up
+     * with (negative if it loses material) when both sides keep recapturing on the target square
+     * with their least valuable attacker, each free to stop when that is better
+     *
+     * Sliders behind an attacker join in (X-rays), pinned pieces stay out while their pinner is on
+     * the board and a king only recaptures on an undefended square. Pieces are worth
+     * Evaluation::materialValues; castling scores 0, a quiet move 0 or less.
+     */
+    int see(const Move move) const;
+    /**
+     * @brief see(move) >= threshold, stopping as soon as the outcome is known
+     */
+    bool seeGE(const Move move, int threshold = 0) const;
+
+    /**
+     * @brief How perft counts the leaves of the tree
+     */
+    enum class PerftMode : uint8_t {
+        BulkCount,  ///< Count the legal moves at depth 1 without playing them
+        MakeUnmake, ///< Play every move down to depth 0, to validate makeMove/unMakeMove
+        CopyMake    ///< Like MakeUnmake, but take moves back by restoring a saved Position
+    };
+
+    /**
+     * @brief Counts the leaf nodes of the legal move tree
+     *
+     * @param table Optional subtree cache. Transposed subtrees are then counted once, at the cost
+     * of exactness on a 64 bit key collision. Pass nullptr for an exact count.
+     */
+    uint64_t perft(int depth, bool verbose = false, PerftMode mode = PerftMode::BulkCount,
+                   PerftTable* table = nullptr);
+    /**
+     * @brief perft on a work stealing pool. The tree is split into enough subtrees (root moves,
+     * deeper plies when the root has too few) for every thread, each thread works on its own copy
+     * of the board. Returns the same count as perft().
+     */
+    uint64_t parallelPerft(int depth, std::size_t threads, bool verbose = false,
+                           PerftMode mode = PerftMode::BulkCount, PerftTable* table = nullptr);
+    void perftDivide(int depth, PerftMode mode = PerftMode::BulkCount);
+
+  private:
+    // The recursion of perft(), table probes and hits counted into counters
+    uint64_t countPerftLeaves(int depth, PerftMode mode, PerftTable* table,
+                              PerftTable::Counters& counters);
+
+    /**
+     * @brief Check and pin bitboards of the current position, see checkers()
+     */
+    struct CheckInfo {
+        BitBoard checkers;
+        std::array<BitBoard, 2> blockersForKing; ///< Indexed by the side of the king
+        std::array<BitBoard, 2> pinners;         ///< Indexed by the side of the slider
+    };
+
+    // Computed on first use after each change to the position, every function that changes the
+    // pieces or the side to move clears checkInfoValid
+    mutable CheckInfo checkInfoCache{};
+    mutable bool checkInfoValid = false;
+
+    const CheckInfo& checkInfo() const {
+        if (!checkInfoValid) computeCheckInfo();
+        return checkInfoCache;
+    }
+    void computeCheckInfo() const;
+
+    // Pushes the record makeMove/makeNullMove need to be taken back
+    void pushUndo(const Move move);
 };
+
+// The attack queries are inline so the move generator's hot loops can inline them too
+
+inline BitBoard Board::attackersTo(int squareIndex, BitBoard occupancy) const {
+    const auto& pieces = currentState.piecesBitBoards;
+    const auto pawn = static_cast<int>(PieceType::Pawn);
+    const auto knight = static_cast<int>(PieceType::Knight);
+    const auto king = static_cast<int>(PieceType::King);
+
+    // A pawn attacks the square from where a pawn of the other side on it would attack
+    return (AttackTables::pawnAttacks<Side::Black>()[squareIndex] & pieces[pawn]) |
+           (AttackTables::pawnAttacks<Side::White>()[squareIndex] & pieces[6 + pawn]) |
+           (AttackTables::knightAttacks[squareIndex] & (pieces[knight] | pieces[6 + knight])) |
+           (AttackTables::kingAttacks[squareIndex] & (pieces[king] | pieces[6 + king])) |
+           (AttackTables::bishopAttacks(squareIndex, occupancy) &
+            (currentState.diagonalSliders[Side::White] | currentState.diagonalSliders[Side::Black])) |
+           (AttackTables::rookAttacks(squareIndex, occupancy) &
+            (currentState.orthoSliders[Side::White] | currentState.orthoSliders[Side::Black]));
+}
+
+template <Side::Value Attacker>
+inline BitBoard Board::attackersTo(int squareIndex, BitBoard occupancy) const {
+    return attackersTo(squareIndex, occupancy) & currentState.colorBitBoards[Attacker];
+}
+
+template <Side::Value Attacker> inline bool Board::isSquareAttacked(Square square) const {
+    return !attackersTo<Attacker>(square.getIndex(), occupancy()).isEmpty();
+}
+
+inline bool Board::isSquareAttacked(Square square, Side attackerSide) const {
+    return (attackerSide == Side::White) ? isSquareAttacked<Side::White>(square)
+                                         : isSquareAttacked<Side::Black>(square);
+}
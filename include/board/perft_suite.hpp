@@ -0,0 +1,69 @@
+/**
+ * @file
+ * @brief Runs perft over an EPD suite of positions with known node counts
+ */
+
+#pragma once
+
+#include "board.hpp"
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace PerftSuite {
+
+/**
+ * @brief One EPD line: a position and its expected node count at each listed depth
+ */
+struct Entry {
+    std::string fen;
+    std::vector<std::pair<int, uint64_t>> expected; ///< (depth, nodes), in file order
+};
+
+struct DepthResult {
+    int depth;
+    uint64_t expected;
+    uint64_t nodes;
+    double seconds;
+
+    bool passed() const { return nodes == expected; }
+};
+
+struct Result {
+    std::string fen;
+    std::vector<DepthResult> depths;
+    std::string error; ///< Why the position could not be run, such as a malformed FEN
+
+
+    bool passed() const;
+    uint64_t nodes() const;
+    double seconds() const;
+};
+
+/**
+ * @brief Parses a line like "<fen> ;D1 20 ;D2 400". The FEN may omit the move clocks.
+ * @throws std::invalid_argument on a malformed depth entry
+ */
+Entry parseLine(const std::string& line);
+
+/**
+ * @brief Parses every line of an EPD stream, skipping blank lines and lines starting with '#'
+ */
+std::vector<Entry> parse(std::istream& input);
+
+/**
+ * @brief Runs every entry, positions in parallel on a work stealing pool. A position that cannot
+ * be set up fails with its error recorded instead of stopping the run.
+ *
+ * @param maxDepth Skip expected counts deeper than this (0 runs all of them)
+ * @return One result per entry, in input order
+ */
+std::vector<Result> run(const std::vector<Entry>& entries, int maxDepth, std::size_t threads,
+                        Board::PerftMode mode = Board::PerftMode::BulkCount);
+
+void writeJson(std::ostream& output, const std::vector<Result>& results, double wallSeconds);
+void writeCsv(std::ostream& output, const std::vector<Result>& results);
+
+} // namespace PerftSuite
@@ -0,0 +1,74 @@
+/**
+ * @file
+ * @brief Hash table caching perft subtree node counts
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @class PerftTable
+ * @brief Maps (position key, depth) to the node count of that subtree.
+ *
+ * Buckets hold two entries: the first keeps the deepest subtree seen for its slot, the second is
+ * always replaced. An entry stores the key xored with its data, so a torn write from another thread
+ * reads back as a miss instead of a wrong count. Counts are only as exact as the 64 bit keys: run
+ * perft without a table when the result has to be exact.
+ *
+ * Probes count into caller owned Counters, which the caller adds to the table's totals once it is
+ * done, so threads sharing the table do not all write one shared counter at every node.
+ */
+class PerftTable {
+  public:
+    struct Counters {
+        uint64_t probes = 0;
+        uint64_t hits = 0;
+    };
+
+    /**
+     * @param megabytes Table size, rounded down to a power of two number of buckets
+     */
+    explicit PerftTable(std::size_t megabytes);
+
+    /**
+     * @brief Looks up the node count of a subtree
+     * @return true and sets nodes on a hit
+     */
+    bool probe(uint64_t key, int depth, uint64_t& nodes, Counters& counters) const;
+    void store(uint64_t key, int depth, uint64_t nodes);
+    void clear();
+
+    /**
+     * @brief Adds the probes and hits of one search of the table to the totals
+     */
+    void addCounters(const Counters& counters);
+
+    std::size_t sizeInBytes() const { return bucketCount * sizeof(Bucket); }
+    uint64_t probes() const { return probeCount.load(std::memory_order_relaxed); }
+    uint64_t hits() const { return hitCount.load(std::memory_order_relaxed); }
+    double hitRate() const;
+
+  private:
+    struct Entry {
+        std::atomic<uint64_t> check{0}; ///< key ^ data
+        std::atomic<uint64_t> data{0};  ///< nodes << 8 | depth
+    };
+    struct Bucket {
+        Entry deepest;
+        Entry recent;
+    };
+
+    // Depth lives in the low byte of data, leaving 56 bits for the node count
+    static constexpr uint64_t depthMask = 0xFF;
+
+    Bucket& bucketFor(uint64_t key) const { return buckets[key & (bucketCount - 1)]; }
+
+    std::unique_ptr<Bucket[]> buckets;
+    std::size_t bucketCount;
+    std::atomic<uint64_t> probeCount{0};
+    std::atomic<uint64_t> hitCount{0};
+};
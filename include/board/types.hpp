@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <iostream>
 #include <stdexcept>
 
@@ -7,9 +8,13 @@ class Side {
     int side;
 
   public:
-    constexpr static bool White = 0;
-    constexpr static bool Black = 1;
-    Side() : side(White) {};
+    /**
+     * @brief Compile time side, for code specialised with template<Side::Value Us>
+     */
+    enum Value : uint8_t { White = 0, Black = 1 };
+
+    constexpr Side() : side(White) {};
+    constexpr Side(Value _side) : side(_side) {};
 
     Side(int _side) : side(_side) {
         if (_side != White && _side != Black) {
@@ -17,19 +22,19 @@ class Side {
         }
     };
 
-    operator int() const { return side; }
+    constexpr operator int() const { return side; }
 
-    Side operator!() const {
+    constexpr Side operator!() const {
         if (side == White) return Black;
         return Side::White;
     }
 
-    bool operator!=(const Side& other) const { return !(*this == other); }
-
-    Side flip() const {
+    constexpr Side flip() const {
         if (side == White) return Black;
         return White;
     }
+
+    static constexpr Value opposite(Value side) { return side == White ? Black : White; }
 };
 
 enum class PieceType { Pawn = 0, Knight = 1, Bishop = 2, Rook = 3, Queen = 4, King = 5, None = 6 };
@@ -84,7 +89,10 @@ struct Piece {
         }
     }
 
-    Piece(int pieceIndex) {}
+    // Inverse of pieceIndex(); indices past the last piece (e.g. an empty mailbox square) give None
+    Piece(int pieceIndex)
+        : side(pieceIndex >= 6 && pieceIndex < 12 ? Side::Black : Side::White),
+          type(pieceIndex < 12 ? static_cast<PieceType>(pieceIndex % 6) : PieceType::None) {}
 
     static bool isSide(const Piece piece, const Side color) { return (piece.side == color); }
 
@@ -0,0 +1,57 @@
+/**
+ * @file
+ * @brief Zobrist keys used to hash positions
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace Zobrist {
+
+/**
+ * @brief SplitMix64 step, good enough to produce well distributed keys at compile time
+ */
+constexpr uint64_t splitMix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+struct Keys {
+    std::array<std::array<uint64_t, 64>, 12> pieceSquare; ///< Indexed by piece index and square
+    uint64_t sideToMove;                                   ///< Xored in when Black is to move
+    std::array<uint64_t, 16> castling;                     ///< Indexed by the castling rights mask
+    std::array<uint64_t, 8> enPassantFile;                 ///< File of the en passant square
+};
+
+static constexpr Keys keys = []() {
+    Keys result{};
+    uint64_t state = 0x5343484D45545445ULL; // Fixed seed so keys are stable across runs
+    for (auto& piece : result.pieceSquare) {
+        for (auto& key : piece) {
+            key = splitMix64(state);
+        }
+    }
+    result.sideToMove = splitMix64(state);
+    // No rights hash to zero, so a position without castling rights needs no castling term
+    result.castling[0] = 0;
+    for (std::size_t rights = 1; rights < result.castling.size(); ++rights) {
+        result.castling[rights] = splitMix64(state);
+    }
+    for (auto& key : result.enPassantFile) {
+        key = splitMix64(state);
+    }
+    return result;
+}();
+
+constexpr uint64_t pieceSquare(int pieceIndex, int squareIndex) {
+    return keys.pieceSquare[pieceIndex][squareIndex];
+}
+constexpr uint64_t sideToMove() { return keys.sideToMove; }
+constexpr uint64_t castling(int rights) { return keys.castling[rights]; }
+constexpr uint64_t enPassantFile(int file) { return keys.enPassantFile[file]; }
+
+} // namespace Zobrist
@@ -0,0 +1,25 @@
+/**
+ * @file
+ * @brief Fixed benchmark: a node count signature plus a throughput number
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+
+namespace Bench {
+
+struct Result {
+    uint64_t nodes;   ///< Total nodes, a signature that only changes when the engine's behaviour does
+    double seconds;   ///< Wall time
+    double nodesPerSecond() const { return seconds > 0 ? nodes / seconds : 0.0; }
+};
+
+/**
+ * @brief Runs the built-in positions through full make/unmake perft and a search at fixed depths,
+ * printing one line per position and run and a summary to output
+ */
+Result run(std::ostream& output);
+
+} // namespace Bench
@@ -32,8 +32,8 @@ class Evaluation {
                                   bool includePieceSquares = true, bool includePawnStructure = true,
                                   bool includeKingSafety = true);
 
-  private:
-    // Material values in centipawns (100 = 1 pawn) indexed by piecetype
+    // Material values in centipawns (100 = 1 pawn) indexed by piecetype, also used by
+    // Board::see
     static constexpr std::array<int, 6> materialValues = {
         100, // Pawn
         320, // Knight
@@ -43,6 +43,7 @@ class Evaluation {
         0    // King (no material value)
     };
 
+  private:
     static constexpr int bishopPairBonus = 50;     // Bonus for having two bishops
     static constexpr int passedPawnBonus = 100;    // Bonus for each passed pawn
     static constexpr int isolatedPawnPenalty = 20; // Penalty for each isolated pawn
@@ -1,7 +1,11 @@
 #pragma once
 
 #include "board/bitboard.hpp"
+#include "board/types.hpp"
 #include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
 
 namespace AttackTables {
 
@@ -75,6 +79,261 @@ static constexpr std::array<BitBoard, 64> rookMasks = []() {
     return masks;
 }();
 
+// Squares strictly between two squares on a common rank, file or diagonal, empty if they are not
+// aligned. Used for check blocking masks and pin detection.
+static constexpr std::array<std::array<BitBoard, 64>, 64> betweenMasks = []() {
+    std::array<std::array<BitBoard, 64>, 64> masks{};
+    for (int square = 0; square < 64; ++square) {
+        for (const auto& direction : queenOffsets) {
+            BitBoard between;
+            auto file = square % 8 + direction.file;
+            auto rank = square / 8 + direction.rank;
+            while (file >= 0 && file < 8 && rank >= 0 && rank < 8) {
+                masks[square][file + rank * 8] = between;
+                between |= squareBB[file + rank * 8];
+                file += direction.file;
+                rank += direction.rank;
+            }
+        }
+    }
+    return masks;
+}();
+
+// Whole line (edge to edge, both squares included) through two aligned squares, empty if they are
+// not aligned. A pinned piece may only move along the line through its king and itself.
+static constexpr std::array<std::array<BitBoard, 64>, 64> lineMasks = []() {
+    std::array<std::array<BitBoard, 64>, 64> masks{};
+    for (int square = 0; square < 64; ++square) {
+        for (const auto& direction : queenOffsets) {
+            const auto ray = computeRayMask(square, direction);
+            const auto line =
+                ray | computeRayMask(square, Offset(-direction.file, -direction.rank)) |
+                squareBB[square];
+            auto target = ray;
+            while (target) {
+                masks[square][target.popLSB().getIndex()] = line;
+            }
+        }
+    }
+    return masks;
+}();
+
+// Slider attacks from a square for a given occupancy, found by walking each ray until it hits a
+// blocker. Only used to build and verify the lookup tables below, never in the hot path.
+constexpr BitBoard computeSlidingAttacks(int squareIndex, BitBoard occupancy,
+                                         const Offset (&directions)[4]) {
+    BitBoard attacks;
+    const auto file = squareIndex % 8;
+    const auto rank = squareIndex / 8;
+    for (const auto& direction : directions) {
+        auto currentFile = file + direction.file;
+        auto currentRank = rank + direction.rank;
+        while (currentFile >= 0 && currentFile < 8 && currentRank >= 0 && currentRank < 8) {
+            const auto target = currentFile + currentRank * 8;
+            attacks |= squareBB[target];
+            if (occupancy & squareBB[target]) break;
+            currentFile += direction.file;
+            currentRank += direction.rank;
+        }
+    }
+    return attacks;
+}
+
+/**
+ * @brief Software parallel bit extract: gathers the bits of source selected by mask into the low
+ * bits of the result. Used where the BMI2 instruction is unavailable.
+ */
+constexpr uint64_t extractBits(uint64_t source, uint64_t mask) {
+    uint64_t result = 0;
+    for (uint64_t bit = 1; mask; bit <<= 1) {
+        if (source & mask & -mask) result |= bit;
+        mask &= mask - 1;
+    }
+    return result;
+}
+
+/**
+ * @brief Software parallel bit deposit, the inverse of extractBits: scatters the low bits of
+ * source onto the set bits of mask.
+ */
+constexpr uint64_t depositBits(uint64_t source, uint64_t mask) {
+    uint64_t result = 0;
+    for (uint64_t bit = 1; mask; bit <<= 1) {
+        if (source & bit) result |= mask & -mask;
+        mask &= mask - 1;
+    }
+    return result;
+}
+
+/**
+ * @brief Hardware PEXT. Emitted as inline assembly so a single binary built without -mbmi2 can
+ * still use it once cpuid has confirmed BMI2 support (see detectSliderBackend).
+ */
+inline uint64_t pext(uint64_t source, uint64_t mask) {
+#if defined(__x86_64__)
+    uint64_t result;
+    asm("pextq %2, %1, %0" : "=r"(result) : "r"(source), "r"(mask));
+    return result;
+#else
+    return extractBits(source, mask);
+#endif
+}
+
+/**
+ * @struct Magic
+ * @brief Fancy magic bitboard entry for one square.
+ *
+ * The relevant occupancy (blockers on the slider rays, board edges excluded) is multiplied by a
+ * magic number so that every distinct blocker pattern lands on a unique slot of a dense per-square
+ * block inside the shared slider attack table.
+ */
+struct Magic {
+    BitBoard mask;     ///< Relevant occupancy mask (rays without their edge squares)
+    uint64_t magic;    ///< Magic multiplier
+    uint32_t offset;   ///< Start of this square's block in sliderAttackTable
+    uint32_t shift;    ///< 64 - number of relevant bits
+
+    inline constexpr uint32_t index(BitBoard occupancy) const {
+        return offset + static_cast<uint32_t>(((occupancy & mask) * magic) >> shift);
+    }
+
+    // Index into pextAttackTable: the blocker bits gathered densely in mask order
+    inline uint32_t pextIndex(BitBoard occupancy) const {
+        return offset + static_cast<uint32_t>(pext(occupancy, mask));
+    }
+};
+
+// Board edges that never block a ray: a blocker on the last square of a ray changes nothing
+constexpr BitBoard edgesFor(int squareIndex) {
+    const auto rankEdges = (rankBB[0] | rankBB[7]) & ~rankBB[squareIndex / 8];
+    const auto fileEdges = (fileBB[0] | fileBB[7]) & ~fileBB[squareIndex % 8];
+    return rankEdges | fileEdges;
+}
+
+// Magic numbers found offline with a brute force search for the shift 64 - popCount(mask)
+static constexpr std::array<uint64_t, 64> bishopMagicNumbers = {
+    0x0040100C088C2540ULL, 0x8004010401160021ULL, 0x0008420852004800ULL,
+    0x4190890208130801ULL, 0x2024042000644000ULL, 0x00208804C0200000ULL,
+    0x8415868808400C24ULL, 0xC800110801242080ULL, 0x0010200441020420ULL,
+    0x0201200404384240ULL, 0x8224414410828200ULL, 0x1050382080260210ULL,
+    0x0020240420000822ULL, 0x000A011008040002ULL, 0x0020110090100840ULL,
+    0x104420820802820CULL, 0x0020010460840102ULL, 0x0108000418280060ULL,
+    0x02A6003020821100ULL, 0x0028001082004000ULL, 0x0012004401210010ULL,
+    0x0200812100A00100ULL, 0x0021000080901010ULL, 0xA000400021041088ULL,
+    0x4809208040021200ULL, 0x0001588004085804ULL, 0x40822800100A8421ULL,
+    0x0040040004410020ULL, 0x900084001A020200ULL, 0x0002008028080102ULL,
+    0x0010811024042E40ULL, 0x0004090000308208ULL, 0x40100820000A0202ULL,
+    0x000A013050049004ULL, 0x0004004410081221ULL, 0x4022202020080080ULL,
+    0xA2A8044240040100ULL, 0x40100124400A0040ULL, 0x0084108A00008821ULL,
+    0x0800A42081990081ULL, 0x0008020310442010ULL, 0x1404088270000800ULL,
+    0x8391040022040400ULL, 0x0011342018004900ULL, 0x0001441294000200ULL,
+    0x0014009804400200ULL, 0x4488024082000421ULL, 0x01080D010A089020ULL,
+    0x0081088821080000ULL, 0xA008220804A40A00ULL, 0x00011A0110880600ULL,
+    0x9100000884040000ULL, 0x0044012803040408ULL, 0x08004882080A1043ULL,
+    0x0041040404404020ULL, 0x0048010802084404ULL, 0x8089808421014002ULL,
+    0x0044102121082000ULL, 0x0000011200620800ULL, 0x000000042020A800ULL,
+    0x5000022040450101ULL, 0x0084080410028200ULL, 0x100A101090011050ULL,
+    0x0003600104010042ULL,
+};
+
+static constexpr std::array<uint64_t, 64> rookMagicNumbers = {
+    0x0080016452400080ULL, 0x2240001000E002C8ULL, 0x0100200010090040ULL,
+    0x2080100008000480ULL, 0x4280020400080081ULL, 0x6100010008040002ULL,
+    0x2880020000800100ULL, 0x2080003041000880ULL, 0x0840800040002080ULL,
+    0x0084804000802000ULL, 0x0005004020010010ULL, 0x0008800804811000ULL,
+    0x0002802800040080ULL, 0xC008012008400410ULL, 0x0459008100040200ULL,
+    0x8001000228518100ULL, 0x0000808000400034ULL, 0x9228210040090084ULL,
+    0x4050018020018010ULL, 0x9810018051080080ULL, 0x0005010004080011ULL,
+    0x0002008004000280ULL, 0x0000040010820108ULL, 0x806212000120408CULL,
+    0x001860858010C000ULL, 0x2810450200220081ULL, 0x0420001010020400ULL,
+    0x0000100100210008ULL, 0x0020040080800800ULL, 0x1014004040020100ULL,
+    0x8C02000200018804ULL, 0x0000184200008C01ULL, 0x0040008000802048ULL,
+    0x0092802001804002ULL, 0x0050100080802000ULL, 0x0000800800801000ULL,
+    0x0008080101001004ULL, 0x4002200408011040ULL, 0x000001280400C210ULL,
+    0x0094800040800100ULL, 0x0040104021898001ULL, 0x0080200050004000ULL,
+    0x3010002000108080ULL, 0x4050100008008080ULL, 0x0000110008010004ULL,
+    0x0021000204010008ULL, 0x000915508804000EULL, 0x1426009045060014ULL,
+    0x2080800040002080ULL, 0x0010002000400040ULL, 0x000020401A820200ULL,
+    0x4800100080080280ULL, 0x006A880010050100ULL, 0x0002000411080200ULL,
+    0x0000800100020080ULL, 0x19920C5120840200ULL, 0x0072001500204882ULL,
+    0x4000410016042082ULL, 0x0000C3220010802AULL, 0x0001142810006101ULL,
+    0x0001001094080007ULL, 0x0803000400080201ULL, 0x1201000200009C61ULL,
+    0x0000002052830402ULL,
+};
+
+// Magic entries for both slider types. Bishop blocks come first in the shared table, followed by
+// the rook blocks.
+static constexpr auto sliderMagics = []() {
+    std::array<std::array<Magic, 64>, 2> magics{};
+    uint32_t offset = 0;
+    for (int square = 0; square < 64; ++square) {
+        const auto mask = bishopMasks[square] & ~edgesFor(square);
+        magics[0][square] = {mask, bishopMagicNumbers[square], offset,
+                             static_cast<uint32_t>(64 - mask.popCount())};
+        offset += 1U << mask.popCount();
+    }
+    for (int square = 0; square < 64; ++square) {
+        const auto mask = rookMasks[square] & ~edgesFor(square);
+        magics[1][square] = {mask, rookMagicNumbers[square], offset,
+                             static_cast<uint32_t>(64 - mask.popCount())};
+        offset += 1U << mask.popCount();
+    }
+    return magics;
+}();
+
+static constexpr auto& bishopMagics = sliderMagics[0];
+static constexpr auto& rookMagics = sliderMagics[1];
+
+// Total number of entries needed by all bishop and rook blocks (5248 + 102400)
+static constexpr std::size_t sliderTableSize =
+    rookMagics[63].offset + (1ULL << (64 - rookMagics[63].shift));
+
+/**
+ * @brief Slider lookup implementations. Magic works everywhere, Pext needs BMI2 and is faster on
+ * CPUs with a native PEXT (Intel Haswell+, AMD Zen 3+).
+ */
+enum class SliderBackend : uint8_t { Magic, Pext };
+
+// Filled at startup in attack_squares.cpp. Building ~860 KB of attacks inside a constant
+// expression exceeds the constexpr evaluation limits of GCC and Clang. The PEXT table shares the
+// per-square block layout of the magic entries, only the index inside a block differs; it stays
+// zero (and untouched in memory) until the Pext backend is selected.
+extern const std::array<BitBoard, sliderTableSize> sliderAttackTable;
+extern std::array<BitBoard, sliderTableSize> pextAttackTable;
+
+// Backend used by the lookups below, chosen with cpuid before main() runs
+extern SliderBackend sliderBackend;
+
+bool cpuSupportsBmi2();
+// Whether PEXT is a native instruction on this CPU vendor and family. AMD before Zen 3 (family
+// 0x19) runs it in microcode, far slower than a magic lookup, and so does Hygon (Zen 1 based).
+bool pextIsFast(std::string_view vendor, unsigned family);
+// BMI2 present and PEXT native
+bool cpuHasFastPext();
+SliderBackend detectSliderBackend();
+// Forces a backend, e.g. for benchmarks, building the PEXT table on first use (once, even if
+// several threads ask at the same time). Throws if Pext is requested on a CPU without BMI2; a slow
+// microcoded PEXT is allowed. Switching backends while lookups run on other threads is a race, so
+// call it before they start.
+void setSliderBackend(SliderBackend backend);
+const char* sliderBackendName(SliderBackend backend);
+
+inline BitBoard bishopAttacks(int squareIndex, BitBoard occupancy) {
+    const auto& entry = bishopMagics[squareIndex];
+    if (sliderBackend == SliderBackend::Pext) return pextAttackTable[entry.pextIndex(occupancy)];
+    return sliderAttackTable[entry.index(occupancy)];
+}
+
+inline BitBoard rookAttacks(int squareIndex, BitBoard occupancy) {
+    const auto& entry = rookMagics[squareIndex];
+    if (sliderBackend == SliderBackend::Pext) return pextAttackTable[entry.pextIndex(occupancy)];
+    return sliderAttackTable[entry.index(occupancy)];
+}
+
+inline BitBoard queenAttacks(int squareIndex, BitBoard occupancy) {
+    return bishopAttacks(squareIndex, occupancy) | rookAttacks(squareIndex, occupancy);
+}
+
 // Helper function to compute attack bitboard at compile-time
 constexpr BitBoard computeKnightAttacks(int squareIndex) {
     uint64_t attacks = 0;
@@ -168,4 +427,15 @@ static constexpr std::array<BitBoard, 64> blackPawnAttacks = []() {
     return attacks;
 }();
 
+/**
+ * @brief Pawn attack table of a side known at compile time
+ */
+template <Side::Value Us> constexpr const std::array<BitBoard, 64>& pawnAttacks() {
+    if constexpr (Us == Side::White) {
+        return whitePawnAttacks;
+    } else {
+        return blackPawnAttacks;
+    }
+}
+
 } // namespace AttackTables
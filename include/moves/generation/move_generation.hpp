@@ -2,44 +2,103 @@
 
 #include "board/bitboard.hpp"
 #include "board/board.hpp"
+#include "moves/move_list.hpp"
 #include "moves/moves.hpp"
-#include <vector>
+
+/**
+ * @brief Which subset of the legal moves a generate<Type>() call produces. Captures and Quiets
+ * partition Legal, so a move picker can ask for captures first and only pay for the quiets after
+ * they failed to cut off.
+ */
+enum class GenType : uint8_t {
+    Captures,    ///< Captures, en passant and all promotions (including non capturing ones)
+    Quiets,      ///< Non capturing, non promoting moves, castling included
+    QuietChecks, ///< The Quiets that give check, directly or by discovery
+    Evasions,    ///< Every legal move when in check, nothing otherwise
+    Legal        ///< Every legal move
+};
 
 /**
  * @class MoveGenerator
  * @brief Takes in the board and generates all possible legal and pseudo legal moves for all pieces
  * on the board
- * TODO: Implement a per piece on board index/information about whether that piece is able to attack
- * the king or not??
+ *
+ * generateMoves() is fully legal: checkers, pinned pieces and the check blocking mask are computed
+ * once per node and every move is filtered against them, so no move is ever made on the board.
+ * generate<Type>() restricts the target squares up front, so a staged mode never builds the moves it
+ * is not asked for. The per piece generate*Moves functions are pseudo legal.
+ *
+ * The side to move is dispatched once per node into code templated on Side::Value, so pawn
+ * directions, promotion ranks, castling squares and pawn attack tables are compile time constants.
  */
 class MoveGenerator {
 
   public:
     MoveGenerator();
-    MoveGenerator(Board& board) : _board(board) {
-        _moveBuffer.reserve(64);
-        _legalMoves.reserve(256);
-    };
+    MoveGenerator(Board& board) : _board(board) {};
+
+    /**
+     * @brief Generates every legal move for the side to move
+     */
+    MoveList generateMoves();
+
+    /**
+     * @brief Generates the legal moves of one stage, see GenType
+     */
+    template <GenType Type> MoveList generate();
 
-    const std::vector<Move> generateMoves();
     bool isLegalMove(const Move move) const;
-    const std::vector<Move> generatePseudoLegalMoves();
+    MoveList generatePseudoLegalMoves();
 
-    void generatePawnMoves(Square square, std::vector<Move>& moves);
-    void generateKnightMoves(Square square, std::vector<Move>& moves);
-    void generateBishopMoves(Square square, std::vector<Move>& moves);
-    void generateRookMoves(Square square, std::vector<Move>& moves);
-    void generateQueenMoves(Square square, std::vector<Move>& moves);
-    void generateKingMoves(Square square, std::vector<Move>& moves);
+    void generatePawnMoves(Square square, MoveList& moves);
+    void generateKnightMoves(Square square, MoveList& moves);
+    void generateBishopMoves(Square square, MoveList& moves);
+    void generateRookMoves(Square square, MoveList& moves);
+    void generateQueenMoves(Square square, MoveList& moves);
+    void generateKingMoves(Square square, MoveList& moves);
 
+    /**
+     * @brief Same as Board::isSquareAttacked, kept for callers that only hold a generator
+     */
     bool isSquareAttacked(Square square, Side attackerSide) const;
+    template <Side::Value Attacker> bool isSquareAttacked(Square square) const;
     BitBoard getAttacksForPiece(Piece piece) const;
 
-    void generateSlidingMoves(Square square, const Offset* directions, int numDirections,
-                              std::vector<Move>& moves) const;
+    void generateSlidingMoves(Square square, BitBoard attacks, MoveList& moves) const;
 
   private:
+    /**
+     * @brief Check and pin information of the side to move, computed once per node
+     */
+    struct LegalContext {
+        int kingSquare;     ///< Square of our king, -1 if there is none
+        BitBoard own;       ///< Our pieces
+        BitBoard enemy;     ///< Their pieces
+        BitBoard occupancy; ///< All pieces
+        BitBoard checkers;  ///< Enemy pieces giving check
+        BitBoard pinned;    ///< Our pieces pinned to our king
+        BitBoard checkMask; ///< Targets that resolve a single check (all squares if not in check)
+
+        // Only filled for GenType::QuietChecks, see computeCheckSquares()
+        int enemyKingSquare;
+        BitBoard checkSquares[6]; ///< Per piece type: squares from which it would check
+        BitBoard discoverers;     ///< Our pieces whose departure uncovers a check by our slider
+    };
+
+    template <Side::Value Us, GenType Type> MoveList generateFor() const;
+    template <Side::Value Us> LegalContext computeLegalContext() const;
+    template <Side::Value Us> void computeCheckSquares(LegalContext& context) const;
+
+    template <Side::Value Us, GenType Type>
+    void generateLegalPawnMoves(const LegalContext& context, MoveList& moves) const;
+    template <Side::Value Us, GenType Type>
+    void generateLegalPieceMoves(const LegalContext& context, MoveList& moves) const;
+    template <Side::Value Us, GenType Type>
+    void generateLegalKingMoves(const LegalContext& context, MoveList& moves) const;
+
+    template <Side::Value Us> void generatePseudoLegalMovesFor(MoveList& moves);
+    template <Side::Value Us> void generatePawnMovesFor(Square square, MoveList& moves);
+    template <Side::Value Us> void generateKingMovesFor(Square square, MoveList& moves);
+
     Board& _board;
-    std::vector<Move> _moveBuffer;
-    std::vector<Move> _legalMoves;
 };
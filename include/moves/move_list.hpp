@@ -0,0 +1,58 @@
+#pragma once
+#include "moves/moves.hpp"
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+
+/**
+ * @class MoveList
+ * @brief
+ * Fixed capacity list of moves stored inline, so generating moves never touches the heap.
+ *
+ * 256 slots cover the largest known number of legal moves in a position (218) as well as every
+ * pseudo legal list the generator can produce. The slots are left uninitialised until a move is
+ * added, creating a list costs nothing.
+ */
+class MoveList {
+  public:
+    static constexpr std::size_t capacity = 256;
+
+    MoveList() = default;
+
+    void push_back(const Move move) {
+        assert(_size < capacity && "MoveList overflow");
+        _moves[_size++] = move;
+    }
+
+    template <typename... Args> Move& emplace_back(Args&&... args) {
+        assert(_size < capacity && "MoveList overflow");
+        _moves[_size] = Move(std::forward<Args>(args)...);
+        return _moves[_size++];
+    }
+
+    void clear() { _size = 0; }
+    void pop_back() { --_size; }
+
+    std::size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    Move& operator[](std::size_t index) { return _moves[index]; }
+    const Move& operator[](std::size_t index) const { return _moves[index]; }
+
+    Move* begin() { return _moves.data(); }
+    Move* end() { return _moves.data() + _size; }
+    const Move* begin() const { return _moves.data(); }
+    const Move* end() const { return _moves.data() + _size; }
+
+    bool contains(const Move move) const {
+        for (const auto& m : *this) {
+            if (m.value() == move.value()) return true;
+        }
+        return false;
+    }
+
+  private:
+    std::array<Move, capacity> _moves;
+    std::size_t _size = 0;
+};
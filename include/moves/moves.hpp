@@ -32,19 +32,26 @@ enum class MoveFlag : std::uint8_t {
  */
 class Move {
   private:
-    int moveValue = 0;
+    uint16_t moveValue;
 
     static constexpr uint16_t startSquareMask = 0x3F;   // 0000000000111111
     static constexpr uint16_t targetSquareMask = 0xFC0; // 0000011111100000
     static constexpr uint16_t flagMask = 0xF000;        // 1111000000000000
 
   public:
+    // Left uninitialised so that move buffers (see MoveList) cost nothing to create. Use Move(0)
+    // for the null move.
+    Move() = default;
+
     Move(uint16_t moveVal) { moveValue = moveVal; }
 
-    Move(int startSquare, int targetSquare) { moveValue = (startSquare | targetSquare << 6); }
+    Move(int startSquare, int targetSquare) {
+        moveValue = static_cast<uint16_t>(startSquare | targetSquare << 6);
+    }
 
     Move(int startSquare, int targetSquare, MoveFlag flag) {
-        moveValue = (startSquare | targetSquare << 6 | static_cast<int>(flag) << 12);
+        moveValue =
+            static_cast<uint16_t>(startSquare | targetSquare << 6 | static_cast<int>(flag) << 12);
     }
 
     // Getter for the raw 16-bit value
@@ -1 +1,217 @@
+/**
+ * @file
+ * @brief Iterative deepening alpha-beta search
+ */
+
 #pragma once
+
+#include "board/board.hpp"
+#include "moves/moves.hpp"
+#include "moves/search/transposition_table.hpp"
+#include "threading/work_stealing_pool.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief When a search stops. A zero node or time limit means no limit.
+ */
+struct SearchLimits {
+    int depth = 64;
+    uint64_t nodes = 0;
+    std::chrono::milliseconds time{0};
+};
+
+/**
+ * @brief How a search with more than one thread shares out the work
+ */
+enum class ParallelMode : uint8_t {
+    LazySmp,    ///< Every thread searches the whole tree, sharing only the transposition table
+    SplitPoints ///< Young brothers wait: the threads split the tree between them at its nodes
+};
+
+/**
+ * @brief The outcome of one completed iteration of the search
+ */
+struct SearchIteration {
+    int depth;
+    int score;      ///< Centipawns for the side to move, or a mate score
+    uint64_t nodes;  ///< Nodes searched so far, all iterations included
+    uint64_t qnodes; ///< The part of nodes searched by the quiescence search
+    double seconds;
+    int hashfull;         ///< Transposition table use in per mille, -1 without a table
+    std::vector<Move> pv; ///< Principal variation, starting with the best move
+
+    uint64_t nodesPerSecond() const {
+        return seconds > 0 ? static_cast<uint64_t>(static_cast<double>(nodes) / seconds) : 0;
+    }
+};
+
+/**
+ * @class Search
+ * @brief Negamax alpha-beta with principal variation search, run by iterative deepening.
+ *
+ * Each iteration searches one ply deeper than the last. The previous principal variation is tried
+ * first, then captures (most valuable victim, least valuable attacker), killer moves and the
+ * remaining quiet moves. After the first move of a node the others are searched with a null window
+ * and only searched again with the full window when they turn out better.
+ *
+ * Leaves are resolved by a quiescence search: the side to move may stand pat on
+ * Evaluation::evaluate or try its captures and queen promotions, until the position is quiet.
+ * Captures that lose material by static exchange, or that could not bring the score back up to
+ * alpha even with a margin, are skipped. In check every evasion is searched instead.
+ *
+ * With a transposition table the best move of an earlier search of the position is tried first,
+ * and null window nodes return the stored score right away when it was searched deep enough and
+ * its bound decides the node.
+ *
+ * The search plays its moves on the board it was given and leaves it as it found it. An iteration
+ * that a limit interrupts is thrown away, the result is the last completed one; the first
+ * iteration always completes so there is a move to play.
+ *
+ * With more than one thread the search is Lazy SMP: helper threads search the same root on their
+ * own copy of the board, with their own killers and principal variation, and only share the
+ * transposition table, which is what speeds up the main thread. Odd helpers run one ply ahead of
+ * the main thread so the threads do not all search the same tree. Only the main thread checks the
+ * limits and reports; when it stops, it raises a shared flag that stops the helpers too.
+ *
+ * In ParallelMode::SplitPoints the threads instead share one tree (young brothers wait). Once the
+ * first move of a node with enough depth left is searched, its younger brothers become tasks of a
+ * work stealing pool. Each task searches its move on a copy of the board and raises the node's
+ * alpha for the tasks that start after it; one that fails high cancels the rest, along with
+ * everything they split off in turn. The thread that owns the node runs pending tasks while it
+ * waits for its own, so every thread keeps working. Any thread checks the time limit and the stop
+ * flag, but only the thread searching the root counts towards the node limit, and only nodes of
+ * finished tasks count at all.
+ */
+class Search {
+  public:
+    static constexpr int infinity = 32000;
+    static constexpr int mateScore = 31000; ///< Mate at the root, mate in n plies is mateScore - n
+    static constexpr int maxPly = 128;
+
+    using Reporter = std::function<void(const SearchIteration&)>;
+
+    /**
+     * @param table Optional, shared with other searches (or threads) that use the same table
+     * @param threads Search threads, the calling thread included. Lazy SMP helpers need a table to
+     * be of any use.
+     * @param mode How more than one thread shares out the work
+     */
+    explicit Search(Board& board, TranspositionTable* table = nullptr, std::size_t threads = 1,
+                    ParallelMode mode = ParallelMode::LazySmp);
+    ~Search();
+
+    /**
+     * @brief Searches the board's position until a limit is hit
+     * @param report Called after every completed iteration, on a pool thread in
+     * ParallelMode::SplitPoints
+     * @return The last completed iteration, an empty pv if the side to move has no legal move
+     */
+    SearchIteration run(const SearchLimits& limits, const Reporter& report = nullptr);
+
+    /**
+     * @brief Asks a running search (on another thread) to stop as soon as possible
+     */
+    void stop() { stopFlag.store(true, std::memory_order_relaxed); }
+
+    /**
+     * @brief Turns delta pruning in the quiescence search on (the default) or off. It is the only
+     * pruning whose outcome depends on the window a node gets, so without it and without a table
+     * the root score no longer depends on move order or on how split point tasks interleave.
+     */
+    void setDeltaPruning(bool enabled) { deltaPruning = enabled; }
+
+    /**
+     * @brief Whether a score announces a mate, for either side
+     */
+    static bool isMateScore(int score) { return std::abs(score) >= mateScore - maxPly; }
+
+    /**
+     * @brief One line in the UCI info format: depth, score (cp or mate), nodes, nps, hashfull (with
+     * a table), time and pv
+     */
+    static std::string formatIteration(const SearchIteration& iteration);
+    /**
+     * @brief A move in UCI notation, such as e2e4 or a7a8q
+     */
+    static std::string uciMove(const Move move);
+
+  private:
+    struct Helper;
+    struct SplitPoint;
+    struct SplitTask;
+    struct SplitWorker;
+
+    // Iterative deepening on this thread, the whole search for the main thread (index 0)
+    SearchIteration iterate(int firstDepth, const Reporter& report);
+    int negamax(int depth, int ply, int alpha, int beta);
+    int quiescence(int ply, int alpha, int beta);
+    // Evaluation::evaluate for the side to move
+    int evaluate() const;
+    // Searches moves[1..] of a node on the pool and waits for them, merging their best into
+    // alpha, bestScore and bestMove. Sets stopped if the node's result is not needed.
+    void searchSplit(const MoveList& moves, int depth, int ply, int& alpha, int beta,
+                     int& bestScore, Move& bestMove);
+    // One task of a split point, called on the node's owner from any pool thread
+    void searchSplitMove(SplitPoint& split, Move move, std::size_t worker);
+    bool shouldStop();
+    // Nodes of all threads
+    uint64_t totalNodes() const;
+    uint64_t totalQuiescenceNodes() const;
+    bool isDraw() const;
+    void orderMoves(MoveList& moves, int ply, Move hashMove) const;
+
+    // Mate scores are stored relative to the node, not the root, so they stay right wherever the
+    // position is found again
+    static int scoreToTable(int score, int ply);
+    static int scoreFromTable(int score, int ply);
+    // Whether a table entry's bound settles a null window node without searching it
+    static bool boundCutsOff(const TranspositionTable::Entry& entry, int score, int alpha,
+                             int beta);
+
+    Board& _board;
+    TranspositionTable* table;
+    std::size_t threadCount;
+    ParallelMode mode;
+    std::size_t threadIndex = 0;
+    bool deltaPruning = true;
+    std::vector<std::unique_ptr<Helper>> helpers;
+    // The search run() was called on; helpers and split tasks share its stop flag
+    Search* mainSearch = this;
+    // Split points only: the pool while run() runs, the worker running this search and the split
+    // point whose task this is (nullptr at the root)
+    WorkStealingPool* pool = nullptr;
+    std::size_t workerIndex = 0;
+    const SplitPoint* splitParent = nullptr;
+    // Split points only, main search: the reusable task contexts of each worker
+    std::vector<SplitWorker> splitWorkers;
+
+    SearchLimits limits;
+    std::chrono::steady_clock::time_point startTime;
+    // Only this thread writes it, the main thread reads it to sum up the nodes of all threads
+    std::atomic<uint64_t> nodes{0};
+    std::atomic<uint64_t> qnodes{0};
+    // Read by the other threads, which may only stop once the main thread has a move
+    std::atomic<int> completedDepth{0};
+    // Set once a limit is hit or the result is not needed, every node then unwinds without
+    // searching
+    bool stopped = false;
+    std::atomic<bool> stopFlag{false};
+
+    // Triangular principal variation table: pv[ply] holds the best line found from ply on
+    std::array<std::array<Move, maxPly>, maxPly> pv;
+    std::array<int, maxPly> pvLength;
+    // The line of the previous iteration, searched first
+    std::vector<Move> previousPv;
+    // Two quiet moves per ply that recently caused a beta cutoff
+    std::array<std::array<Move, 2>, maxPly> killers;
+};
@@ -0,0 +1,105 @@
+/**
+ * @file
+ * @brief Hash table sharing search results between transposed positions and search threads
+ */
+
+#pragma once
+
+#include "moves/moves.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @class TranspositionTable
+ * @brief Maps a position's Zobrist key to the best move, score, static evaluation and depth of its
+ * last search.
+ *
+ * A bucket is one 64 byte cache line of four entries. An entry is two 64 bit atomics: the packed
+ * data and the key xored with it, so a torn write by another thread reads back as a miss and no
+ * lock is needed. When a bucket is full the entry with the least depth, counting every search
+ * since it was written as eight plies less, is replaced. Call newSearch() before every search so
+ * entries of earlier searches age.
+ */
+class TranspositionTable {
+  public:
+    /**
+     * @brief What the stored score says about the true score of the position
+     */
+    enum class Bound : uint8_t {
+        None,  ///< Empty entry
+        Upper, ///< No move reached alpha, the score is at most this
+        Lower, ///< A move reached beta, the score is at least this
+        Exact
+    };
+
+    struct Entry {
+        Move move; ///< Move(0) if there is none
+        int score;
+        int eval; ///< noEval if the static evaluation was not computed
+        int depth;
+        Bound bound;
+    };
+
+    static constexpr int noEval = INT16_MIN;
+
+    /**
+     * @param megabytes Table size, rounded down to a power of two number of buckets
+     */
+    explicit TranspositionTable(std::size_t megabytes);
+
+    /**
+     * @brief Reallocates the table, all entries are lost
+     */
+    void resize(std::size_t megabytes);
+    void clear();
+    /**
+     * @brief Starts a new search, entries written before it are replaced first
+     */
+    void newSearch() { age = (age + 1) & ageMask; }
+
+    /**
+     * @brief Looks up a position
+     * @return true and fills entry on a hit
+     */
+    bool probe(uint64_t key, Entry& entry) const;
+    /**
+     * @brief Saves the result of a search. A search of the same position only replaces it when
+     * it went about as deep, gave an exact score or the old entry is from an earlier search; the
+     * old move is kept if the new search has none.
+     */
+    void store(uint64_t key, Move move, int score, int eval, int depth, Bound bound);
+
+    /**
+     * @brief Per mille of the sampled entries that were written during the current search
+     */
+    int hashfull() const;
+    std::size_t sizeInBytes() const { return bucketCount * sizeof(Bucket); }
+
+  private:
+    struct Slot {
+        std::atomic<uint64_t> check{0}; ///< key ^ data
+        std::atomic<uint64_t> data{0};  ///< See pack()
+    };
+    static constexpr std::size_t slotsPerBucket = 4;
+    struct alignas(64) Bucket {
+        Slot slots[slotsPerBucket];
+    };
+    static_assert(sizeof(Bucket) == 64, "A bucket must fill exactly one cache line");
+
+    // data layout: move (16 bits) | score (16) | eval (16) | depth (8) | bound (2) | age (6)
+    static constexpr uint8_t ageMask = 0x3F;
+    static uint64_t pack(Move move, int score, int eval, int depth, Bound bound, uint8_t age);
+    static Entry unpack(uint64_t data);
+    static uint8_t ageOf(uint64_t data) { return static_cast<uint8_t>(data >> 58); }
+    static int depthOf(uint64_t data) { return static_cast<int8_t>(data >> 48); }
+    static Bound boundOf(uint64_t data) { return static_cast<Bound>((data >> 56) & 0x3); }
+
+    Bucket& bucketFor(uint64_t key) const { return buckets[key & (bucketCount - 1)]; }
+
+    std::unique_ptr<Bucket[]> buckets;
+    std::size_t bucketCount = 0;
+    uint8_t age = 0;
+};
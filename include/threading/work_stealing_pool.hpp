@@ -0,0 +1,85 @@
+/**
+ * @file
+ * @brief Fixed size thread pool whose workers steal tasks from each other
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class WorkStealingPool
+ * @brief Every worker owns a task deque. It pops its own tasks from the back (most recently pushed,
+ * still warm in cache) and, once empty, steals from the front of the other deques, so an uneven
+ * split of the work still keeps all cores busy.
+ *
+ * Tasks get the index of the worker running them, which lets callers keep per worker state (such as
+ * a Board copy) without any locking.
+ */
+class WorkStealingPool {
+  public:
+    using Task = std::function<void(std::size_t workerIndex)>;
+
+    explicit WorkStealingPool(std::size_t threadCount);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    std::size_t size() const { return workers.size(); }
+
+    /**
+     * @brief Queues a task, distributing tasks round robin over the worker deques
+     */
+    void submit(Task task);
+    /**
+     * @brief Queues a task on one worker's deque, for a task handing out work of its own: the
+     * worker keeps it unless another one runs out and steals it
+     */
+    void submit(Task task, std::size_t workerIndex);
+
+    /**
+     * @brief Blocks until every submitted task has finished
+     */
+    void wait();
+
+    /**
+     * @brief Runs one queued task on the calling thread, its own deque first, then stolen
+     *
+     * For tasks that wait on tasks they submitted themselves: helping instead of blocking keeps
+     * every thread busy and cannot deadlock, however deeply the tasks nest.
+     * @param workerIndex Index of the calling worker, as passed to its task
+     * @return false if there was no task to run
+     */
+    bool runPendingTask(std::size_t workerIndex);
+
+  private:
+    struct TaskQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void push(Task task, std::size_t queueIndex);
+    bool popLocal(std::size_t workerIndex, Task& task);
+    bool steal(std::size_t workerIndex, Task& task);
+    void workerLoop(std::size_t workerIndex);
+
+    std::vector<std::unique_ptr<TaskQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex stateMutex;
+    std::condition_variable workAvailable;
+    std::condition_variable allDone;
+    std::atomic<std::size_t> queued{0};  ///< Tasks sitting in a deque
+    std::atomic<std::size_t> pending{0}; ///< Tasks submitted but not finished
+    std::size_t nextQueue = 0;
+    bool stopping = false;
+};
@@ -1,6 +1,12 @@
 #include "board/board.hpp"
+#include "board/zobrist.hpp"
+#include "evaluation/evaluation.hpp"
 #include "moves/generation/attack_squares.hpp"
+#include "threading/work_stealing_pool.hpp"
+#include <algorithm>
 #include <chrono>
+#include <iomanip>
+#include <stdexcept>
 #include <string>
 
 // Define static member
@@ -14,10 +20,56 @@ void Board::movePiece(const Piece movedPiece, const int start, const int target)
     // Clear the piece from the starting square
     currentState.piecesBitBoards[movedPiece.pieceIndex()].clear(from);
     currentState.colorBitBoards[movedPiece.side].clear(from);
+    currentState.mailbox[start] = BoardState::noPiece;
+    zobristKey ^= Zobrist::pieceSquare(movedPiece.pieceIndex(), start);
 
     // Set the piece at the target square
     currentState.piecesBitBoards[movedPiece.pieceIndex()].set(to);
     currentState.colorBitBoards[movedPiece.side].set(to);
+    currentState.mailbox[target] = movedPiece.pieceIndex();
+    zobristKey ^= Zobrist::pieceSquare(movedPiece.pieceIndex(), target);
+    checkInfoValid = false;
+}
+
+void Board::putPiece(const Piece piece, const Square square) {
+    currentState.piecesBitBoards[piece.pieceIndex()].set(square);
+    currentState.colorBitBoards[piece.side].set(square);
+    currentState.mailbox[square.getIndex()] = piece.pieceIndex();
+    zobristKey ^= Zobrist::pieceSquare(piece.pieceIndex(), square.getIndex());
+    checkInfoValid = false;
+}
+
+void Board::removePiece(const Piece piece, const Square square) {
+    currentState.piecesBitBoards[piece.pieceIndex()].clear(square);
+    currentState.colorBitBoards[piece.side].clear(square);
+    currentState.mailbox[square.getIndex()] = BoardState::noPiece;
+    zobristKey ^= Zobrist::pieceSquare(piece.pieceIndex(), square.getIndex());
+    checkInfoValid = false;
+}
+
+uint64_t Board::computeZobristKey() const {
+    uint64_t key = 0;
+    for (int pieceIndex = 0; pieceIndex < 12; ++pieceIndex) {
+        auto pieces = currentState.piecesBitBoards[pieceIndex];
+        while (pieces) {
+            key ^= Zobrist::pieceSquare(pieceIndex, pieces.popLSB().getIndex());
+        }
+    }
+    if (side == Side::Black) key ^= Zobrist::sideToMove();
+    key ^= Zobrist::castling(castlingRights);
+    if (enPassantSquare.has_value()) key ^= Zobrist::enPassantFile(enPassantSquare->getFile());
+    return key;
+}
+
+/**
+ * @brief Xors the castling and en passant terms of the current state in or out of the key. Called
+ * once before and once after these fields change.
+ */
+void Board::toggleStateKey() {
+    zobristKey ^= Zobrist::castling(castlingRights);
+    if (enPassantSquare.has_value()) {
+        zobristKey ^= Zobrist::enPassantFile(enPassantSquare->getFile());
+    }
 }
 
 void Board::updateSliderBitboards() {
@@ -39,19 +91,7 @@ Piece Board::getPieceAt(const Square s) const {
         return Piece(PieceType::None, Side::White); // Return none for invalid squares
     }
 
-    // Iterate over all piece bitboards (12 total: 6 per side)
-    for (auto i = 0; i < 12; ++i) {
-
-        if (currentState.piecesBitBoards[i].contains(s)) {
-            // Calculate side and piece type from index
-            const auto side = static_cast<Side>(i / 6);        // 0 for White, 1 for Black
-            const auto type = static_cast<PieceType>((i % 6)); // 0=None, 1=Pawn, ..., 6=King
-            return Piece(type, side);
-        }
-    }
-
-    // No piece found at the square
-    return Piece(PieceType::None, Side::White);
+    return Piece(static_cast<int>(currentState.mailbox[s.getIndex()]));
 }
 
 Piece Board::getPieceAt(const std::string squareName) const {
@@ -59,360 +99,496 @@ Piece Board::getPieceAt(const std::string squareName) const {
     return getPieceAt(s);
 }
 
-// TODO: Implement Pawn Promotion if not done yet
-Board::UndoInfo Board::makeMove(const Square from, const Square to) {
-    UndoInfo undoInfo{from,           to,           getPieceAt(from),
-                      std::nullopt,   std::nullopt, enPassantSquare,
-                      castlingRights, halfMoveClock};
+namespace {
+
+MoveFlag promotionFlag(PieceType promotion) {
+    switch (promotion) {
+    case PieceType::Knight:
+        return MoveFlag::PromoteToKnightFlag;
+    case PieceType::Bishop:
+        return MoveFlag::PromoteToBishopFlag;
+    case PieceType::Rook:
+        return MoveFlag::PromoteToRookFlag;
+    case PieceType::Queen:
+        return MoveFlag::PromoteToQueenFlag;
+    default:
+        return MoveFlag::NoFlag;
+    }
+}
 
-    // Check if this is a capture move
-    const auto startPiece = getPieceAt(from);
-    const auto targetPiece = getPieceAt(to);
-    if (targetPiece.type != PieceType::None && startPiece.type != PieceType::None) {
-        undoInfo.capturedPiece = targetPiece;
+// Castling rights that survive a move from or to each square: moving the king or a rook, or
+// capturing a rook, clears the rights that piece was needed for
+constexpr std::array<uint8_t, 64> castlingMasks = []() {
+    std::array<uint8_t, 64> masks{};
+    masks.fill(Board::whiteKingside | Board::whiteQueenside | Board::blackKingside |
+               Board::blackQueenside);
+    masks[0] &= ~Board::whiteQueenside;                          // a1
+    masks[4] &= ~(Board::whiteKingside | Board::whiteQueenside); // e1
+    masks[7] &= ~Board::whiteKingside;                           // h1
+    masks[56] &= ~Board::blackQueenside;                         // a8
+    masks[60] &= ~(Board::blackKingside | Board::blackQueenside); // e8
+    masks[63] &= ~Board::blackKingside;                          // h8
+    return masks;
+}();
+
+// Xors a piece on or off the given squares in every bitboard that holds it, slider sets included.
+// The mailbox and the key are left to the caller.
+inline void togglePiece(BoardState& state, int pieceIndex, BitBoard squares) {
+    const auto pieceSide = pieceIndex / 6;
+    const auto type = static_cast<PieceType>(pieceIndex % 6);
+    state.piecesBitBoards[pieceIndex] ^= squares;
+    state.colorBitBoards[pieceSide] ^= squares;
+    if (type == PieceType::Bishop || type == PieceType::Queen) {
+        state.diagonalSliders[pieceSide] ^= squares;
+    }
+    if (type == PieceType::Rook || type == PieceType::Queen) {
+        state.orthoSliders[pieceSide] ^= squares;
+    }
+}
 
-        // Remove captured piece from bitboards
-        currentState.piecesBitBoards[targetPiece.pieceIndex()].clear(to);
-        currentState.colorBitBoards[targetPiece.side].clear(to);
+inline BitBoard squareMask(int square) { return BitBoard(1ULL << square); }
 
-        // Reset halfmove clock on capture
-        halfMoveClock = 0;
-    } else {
-        // Check for en passant capture
-        if (undoInfo.movedPiece.type == PieceType::Pawn && enPassantSquare.has_value() &&
-            to == enPassantSquare.value()) {
+// Rook squares of a castling move, given the king's target square
+inline std::pair<int, int> castlingRookSquares(int kingTarget) {
+    const auto rankBase = kingTarget & ~7;
+    return (kingTarget & 7) == 6 ? std::pair{rankBase + 7, rankBase + 5}
+                                 : std::pair{rankBase, rankBase + 3};
+}
 
-            // Determine the captured pawn's square
-            const auto capturedPawnRank =
-                (side == Side::White) ? to.getRankIndex() - 1 : to.getRankIndex() + 1;
-            const Square capturedPawnSquare(to.getFile(), capturedPawnRank);
+} // namespace
 
-            // Store the captured pawn
-            const auto capturedPawn = getPieceAt(capturedPawnSquare);
-            undoInfo.capturedPiece = capturedPawn;
+void Board::pushUndo(const Move move) {
+    if (undoCount == maxPly) throw std::length_error("Undo stack full, game longer than maxPly");
 
-            // Remove the captured pawn
+    undoStack[undoCount++] = {
+        zobristKey,
+        move,
+        static_cast<uint16_t>(halfMoveClock),
+        BoardState::noPiece,
+        castlingRights,
+        enPassantSquare ? static_cast<uint8_t>(enPassantSquare->getFile()) : noEnPassantFile};
+}
 
-            currentState.piecesBitBoards[capturedPawn.pieceIndex()].clear(capturedPawnSquare);
-            currentState.colorBitBoards[capturedPawn.side].clear(capturedPawnSquare);
+void Board::makeMove(const Square from, const Square to, const PieceType promotion) {
+    makeMove(flaggedMove(from, to, promotion));
+}
 
-            // Reset halfmove clock on capture
-            halfMoveClock = 0;
-        }
+Move Board::flaggedMove(const Square from, const Square to, const PieceType promotion) const {
+    if (promotion != PieceType::None) {
+        return Move(from.getIndex(), to.getIndex(), promotionFlag(promotion));
     }
 
-    // Handle pawn moves
-    if (undoInfo.movedPiece.type == PieceType::Pawn) {
-        // Reset halfmove clock on pawn move
-        halfMoveClock = 0;
-
-        // Check for pawn double move
-        const auto rankDiff = std::abs(to.getRankIndex() - from.getRankIndex());
-        if (rankDiff == 2) {
-            // Set en passant square
-            const auto epRank =
-                (side == Side::White) ? from.getRankIndex() + 1 : from.getRankIndex() - 1;
-            enPassantSquare = Square(from.getFile(), epRank);
-        } else {
-            // Clear en passant square if not a double pawn move
-            enPassantSquare = std::nullopt;
+    const auto piece = getPieceAt(from);
+    auto flag = MoveFlag::NoFlag;
+    if (piece.type == PieceType::King && std::abs(to.getFile() - from.getFile()) == 2) {
+        flag = MoveFlag::CastleFlag;
+    } else if (piece.type == PieceType::Pawn) {
+        if (enPassantSquare.has_value() && to == enPassantSquare.value()) {
+            flag = MoveFlag::EnPassantCaptureFlag;
+        } else if (std::abs(to.getRankIndex() - from.getRankIndex()) == 2) {
+            flag = MoveFlag::PawnTwoUpFlag;
         }
+    }
+    return Move(from.getIndex(), to.getIndex(), flag);
+}
 
-        // Handle promotion (needs to be expanded based on Move class flags)
-        // This part would use Move::getMoveFlag() to determine promotion piece
-    } else {
-        // Clear en passant square if not a pawn move
-        enPassantSquare = std::nullopt;
-
-        // Handle castling
-        if (undoInfo.movedPiece.type == PieceType::King) {
-            const auto fileDiff = to.getFile() - from.getFile();
-
-            // Kingside castling
-            if (fileDiff == 2) {
-                // Move the rook
-                Square rookFrom(7, from.getRankIndex());
-                Square rookTo(5, from.getRankIndex());
-                const auto rook = getPieceAt(rookFrom);
-                movePiece(rook, rookFrom.getIndex(), rookTo.getIndex());
-            }
-            // Queenside castling
-            else if (fileDiff == -2) {
-                // Move the rook
-                Square rookFrom(0, from.getRankIndex());
-                Square rookTo(3, from.getRankIndex());
-                const auto rook = getPieceAt(rookFrom);
-                movePiece(rook, rookFrom.getIndex(), rookTo.getIndex());
-            }
+void Board::makeMove(const Move move) {
+    pushUndo(move);
 
-            // Update castling rights after king move
-            if (side == Side::White) {
-                castlingRights &= ~(whiteKingside | whiteQueenside);
-            } else {
-                castlingRights &= ~(blackKingside | blackQueenside);
-            }
-        }
+    const auto from = move.startSquareIndex();
+    const auto to = move.targetSquareIndex();
+    const auto flag = move.getMoveFlag();
+    const auto us = static_cast<int>(side);
+    const int movedPiece = currentState.mailbox[from];
+    const auto movedType = static_cast<PieceType>(movedPiece % 6);
 
-        // Update castling rights after rook moves
-        if (undoInfo.movedPiece.type == PieceType::Rook) {
-            if (side == Side::White) {
-                if (from == Square("A1")) castlingRights &= ~whiteQueenside;
-                if (from == Square("H1")) castlingRights &= ~whiteKingside;
-            } else {
-                if (from == Square("A8")) castlingRights &= ~blackQueenside;
-                if (from == Square("H8")) castlingRights &= ~blackKingside;
-            }
-        }
-
-        // Update castling rights after rook captures
-        if (undoInfo.capturedPiece.has_value()) {
-            const auto captured = undoInfo.capturedPiece.value();
-            if (captured.type == PieceType::Rook) {
-                if (captured.side == Side::White) {
-                    if (to == Square("A1")) castlingRights &= ~whiteQueenside;
-                    if (to == Square("H1")) castlingRights &= ~whiteKingside;
-                } else {
-                    if (to == Square("A8")) castlingRights &= ~blackQueenside;
-                    if (to == Square("H8")) castlingRights &= ~blackKingside;
-                }
-            }
-        }
-
-        // Increment halfmove clock for non-pawn, non-capture moves
-        halfMoveClock++;
+    toggleStateKey();
+    enPassantSquare = std::nullopt;
+    ++halfMoveClock;
+
+    // Captures, the en passant pawn sits behind the target square
+    const auto captureSquare =
+        flag == MoveFlag::EnPassantCaptureFlag ? (us == Side::White ? to - 8 : to + 8) : to;
+    const int capturedPiece = currentState.mailbox[captureSquare];
+    if (capturedPiece != BoardState::noPiece) {
+        undoStack[undoCount - 1].capturedPiece = static_cast<uint8_t>(capturedPiece);
+        togglePiece(currentState, capturedPiece, squareMask(captureSquare));
+        currentState.mailbox[captureSquare] = BoardState::noPiece;
+        zobristKey ^= Zobrist::pieceSquare(capturedPiece, captureSquare);
+        halfMoveClock = 0;
     }
 
     // Move the piece
-    movePiece(undoInfo.movedPiece, from.getIndex(), to.getIndex());
+    togglePiece(currentState, movedPiece, squareMask(from) | squareMask(to));
+    currentState.mailbox[from] = BoardState::noPiece;
+    currentState.mailbox[to] = static_cast<uint8_t>(movedPiece);
+    zobristKey ^= Zobrist::pieceSquare(movedPiece, from) ^ Zobrist::pieceSquare(movedPiece, to);
+    castlingRights &= castlingMasks[from] & castlingMasks[to];
+
+    if (movedType == PieceType::Pawn) {
+        halfMoveClock = 0;
+        if (flag == MoveFlag::PawnTwoUpFlag) {
+            enPassantSquare = Square((from + to) / 2);
+        } else if (move.isPromotion()) {
+            // Replace the pawn with the promoted piece
+            const auto promotedPiece = us * 6 + static_cast<int>(move.getPromotionPieceType());
+            togglePiece(currentState, movedPiece, squareMask(to));
+            togglePiece(currentState, promotedPiece, squareMask(to));
+            currentState.mailbox[to] = static_cast<uint8_t>(promotedPiece);
+            zobristKey ^=
+                Zobrist::pieceSquare(movedPiece, to) ^ Zobrist::pieceSquare(promotedPiece, to);
+        }
+    } else if (flag == MoveFlag::CastleFlag) {
+        const auto [rookFrom, rookTo] = castlingRookSquares(to);
+        const auto rook = us * 6 + static_cast<int>(PieceType::Rook);
+        togglePiece(currentState, rook, squareMask(rookFrom) | squareMask(rookTo));
+        currentState.mailbox[rookFrom] = BoardState::noPiece;
+        currentState.mailbox[rookTo] = static_cast<uint8_t>(rook);
+        zobristKey ^= Zobrist::pieceSquare(rook, rookFrom) ^ Zobrist::pieceSquare(rook, rookTo);
+    }
 
     // Change side to move
     side = !side;
+    zobristKey ^= Zobrist::sideToMove();
+    toggleStateKey();
 
     // Increment fullmove counter after Black's move
     if (side == Side::White) {
         fullMoveClock++;
     }
 
-    // Update slider bitboards
-    updateSliderBitboards();
+    // The check and pin bitboards belong to the previous position
+    checkInfoValid = false;
 
-    // Reset check cache
-    inCheckCache = false;
+    assert(isConsistent() && "Mailbox out of sync with bitboards after makeMove");
+    assert(zobristKey == computeZobristKey() && "Incremental key out of sync after makeMove");
+}
 
-    // Store move in history
-    undoHistory.push_back(undoInfo);
+void Board::unMakeMove([[maybe_unused]] const Move move) {
+    assert(undoCount > 0 && "unMakeMove without a move to take back");
+    const auto& undoInfo = undoStack[--undoCount];
+    assert(undoInfo.move.from() == move.from() && undoInfo.move.to() == move.to() &&
+           "unMakeMove called with another move");
 
-    return undoInfo;
-}
+    // The record holds the move as it was played, flags included, so callers may pass the move
+    // without them
+    const auto played = undoInfo.move;
+    const auto from = played.startSquareIndex();
+    const auto to = played.targetSquareIndex();
+    const auto flag = played.getMoveFlag();
+
+    // Change side back
+    side = !side;
+    const auto us = static_cast<int>(side);
+
+    // Turn a promoted piece back into the pawn
+    int movedPiece = currentState.mailbox[to];
+    if (played.isPromotion()) {
+        const auto pawn = us * 6 + static_cast<int>(PieceType::Pawn);
+        togglePiece(currentState, movedPiece, squareMask(to));
+        togglePiece(currentState, pawn, squareMask(to));
+        movedPiece = pawn;
+    }
 
-void Board::unMakeMove(const Square from, const Square to, const UndoInfo& undoInfo) {
     // Move the piece back
-    movePiece(undoInfo.movedPiece, to.getIndex(), from.getIndex());
+    togglePiece(currentState, movedPiece, squareMask(from) | squareMask(to));
+    currentState.mailbox[from] = static_cast<uint8_t>(movedPiece);
+    currentState.mailbox[to] = BoardState::noPiece;
 
     // Restore captured piece if any
-    if (undoInfo.capturedPiece.has_value()) {
-        const auto captured = undoInfo.capturedPiece.value();
-
-        // Handle en passant capture specially
-        if (undoInfo.movedPiece.type == PieceType::Pawn &&
-            undoInfo.previousEnPassantSquare.has_value() &&
-            to == undoInfo.previousEnPassantSquare.value()) {
-
-            // Calculate the square where the captured pawn should be restored
-            const auto capturedPawnRank = (undoInfo.movedPiece.side == Side::White)
-                                              ? to.getRankIndex() - 1
-                                              : to.getRankIndex() + 1;
-            Square capturedPawnSquare(to.getFile(), capturedPawnRank);
-
-            // Restore the captured pawn
-            currentState.piecesBitBoards[captured.pieceIndex()].set(capturedPawnSquare);
-            currentState.colorBitBoards[captured.side].set(capturedPawnSquare);
-        } else {
-            // Restore normal capture
-            currentState.piecesBitBoards[captured.pieceIndex()].set(to);
-            currentState.colorBitBoards[captured.side].set(to);
-        }
+    if (undoInfo.capturedPiece != BoardState::noPiece) {
+        const auto captureSquare =
+            flag == MoveFlag::EnPassantCaptureFlag ? (us == Side::White ? to - 8 : to + 8) : to;
+        togglePiece(currentState, undoInfo.capturedPiece, squareMask(captureSquare));
+        currentState.mailbox[captureSquare] = undoInfo.capturedPiece;
     }
 
-    // Restore castling
-    if (undoInfo.movedPiece.type == PieceType::King) {
-        const auto fileDiff = to.getFile() - from.getFile();
-
-        // Kingside castling
-        if (fileDiff == 2) {
-            // Move the rook back
-            const Square rookFrom(7, from.getRankIndex());
-            const Square rookTo(5, from.getRankIndex());
-            const Piece rook(PieceType::Rook, undoInfo.movedPiece.side);
-            movePiece(rook, rookTo.getIndex(), rookFrom.getIndex());
-        }
-        // Queenside castling
-        else if (fileDiff == -2) {
-            // Move the rook back
-            const Square rookFrom(0, from.getRankIndex());
-            const Square rookTo(3, from.getRankIndex());
-            const Piece rook(PieceType::Rook, undoInfo.movedPiece.side);
-            movePiece(rook, rookTo.getIndex(), rookFrom.getIndex());
-        }
+    // Move the rook back
+    if (flag == MoveFlag::CastleFlag) {
+        const auto [rookFrom, rookTo] = castlingRookSquares(to);
+        const auto rook = us * 6 + static_cast<int>(PieceType::Rook);
+        togglePiece(currentState, rook, squareMask(rookFrom) | squareMask(rookTo));
+        currentState.mailbox[rookTo] = BoardState::noPiece;
+        currentState.mailbox[rookFrom] = static_cast<uint8_t>(rook);
     }
 
     // Restore previous state values
-    enPassantSquare = undoInfo.previousEnPassantSquare;
+    enPassantSquare = std::nullopt;
+    if (undoInfo.previousEnPassantFile != noEnPassantFile) {
+        enPassantSquare =
+            Square(static_cast<int>(undoInfo.previousEnPassantFile), us == Side::White ? 5 : 2);
+    }
     castlingRights = undoInfo.previousCastlingRights;
     halfMoveClock = undoInfo.previousHalfmoveClock;
-
-    // Change side back
-    side = !side;
+    zobristKey = undoInfo.previousKey;
 
     // Decrement fullmove counter if necessary
     if (side == Side::Black) {
         fullMoveClock--;
     }
 
-    // Update slider bitboards
-    updateSliderBitboards();
+    // The check and pin bitboards belong to the previous position
+    checkInfoValid = false;
 
-    // Reset check cache
-    inCheckCache = false;
+    assert(isConsistent() && "Mailbox out of sync with bitboards after unMakeMove");
+    assert(zobristKey == computeZobristKey() && "Incremental key out of sync after unMakeMove");
+}
 
-    // Remove the last entry from move history
-    if (!undoHistory.empty()) {
-        undoHistory.pop_back();
-    }
+void Board::restore(const Position& saved) {
+    static_cast<Position&>(*this) = saved;
+    if (undoCount > 0) --undoCount;
+    checkInfoValid = false;
+
+    assert(isConsistent() && "Mailbox out of sync with bitboards after restore");
 }
 
-void Board::makeNullMove() {
-    UndoInfo nullMove{Square::None,   Square::None, Piece(PieceType::None, side),
-                      std::nullopt,   std::nullopt, enPassantSquare,
-                      castlingRights, halfMoveClock};
+void Board::copyRecent(const Board& other) {
+    static_cast<Position&>(*this) = other;
+    const auto recent = std::min<std::size_t>(other.halfMoveClock, other.undoCount);
+    std::copy(other.undoStack.begin() + (other.undoCount - recent),
+              other.undoStack.begin() + other.undoCount, undoStack.begin());
+    undoCount = recent;
+    checkInfoValid = false;
+}
 
-    // Store the null move
-    undoHistory.push_back(nullMove);
+void Board::makeNullMove() {
+    pushUndo(Move(0));
 
     // Clear en passant square
+    toggleStateKey();
     enPassantSquare = std::nullopt;
+    toggleStateKey();
 
     // Switch sides
     side = !side;
+    zobristKey ^= Zobrist::sideToMove();
 
     // Increment fullmove counter if necessary
     if (side == Side::White) {
         fullMoveClock++;
     }
 
-    // Reset check cache
-    inCheckCache = false;
+    // The check and pin bitboards belong to the previous position
+    checkInfoValid = false;
 
     // Increment halfmove clock
     halfMoveClock++;
-}
 
-// TODO: Revisit one move generation is done
-bool Board::calculateInCheckState() const {
+    assert(zobristKey == computeZobristKey() && "Incremental key out of sync after makeNullMove");
+}
 
-    const auto kingIndex = static_cast<int>(side) * 6 + static_cast<int>(PieceType::King);
-    auto kingBB = currentState.piecesBitBoards[kingIndex];
-    Square kingSquare(kingBB.popLSB());
+void Board::unmakeNullMove() {
+    assert(undoCount > 0 && "unmakeNullMove without a null move to take back");
+    const auto& undoInfo = undoStack[--undoCount];
+    assert(undoInfo.move.isNull() && "unmakeNullMove called after a real move");
 
-    if (kingSquare == Square::None) {
-        // King not found, shouldn't happen in a valid position
-        return false;
+    side = !side;
+    enPassantSquare = std::nullopt;
+    if (undoInfo.previousEnPassantFile != noEnPassantFile) {
+        enPassantSquare = Square(static_cast<int>(undoInfo.previousEnPassantFile), side == Side::White ? 5 : 2);
+    }
+    castlingRights = undoInfo.previousCastlingRights;
+    halfMoveClock = undoInfo.previousHalfmoveClock;
+    zobristKey = undoInfo.previousKey;
+    if (side == Side::Black) {
+        fullMoveClock--;
     }
 
-    // Enemy side
-    const auto enemy = !side;
+    checkInfoValid = false;
 
-    // Check for pawn attacks
-    const auto pawnAttackDir = (side == Side::White) ? 1 : -1;
+    assert(zobristKey == computeZobristKey() && "Incremental key out of sync after unmakeNullMove");
+}
 
-    // Check diagonal left
-    auto pawnCheckSquare = kingSquare.tryOffset(Offset(-1, pawnAttackDir));
-    if (pawnCheckSquare != Square::None) {
-        const auto piece = getPieceAt(pawnCheckSquare);
-        if (piece.type == PieceType::Pawn && piece.side == enemy) {
-            return true;
+void Board::computeCheckInfo() const {
+    const auto& state = currentState;
+    const auto occupancy = this->occupancy();
+    checkInfoCache = CheckInfo{};
+
+    for (const auto kingSide : {Side::White, Side::Black}) {
+        const auto king = state.piecesBitBoards[kingSide * 6 + static_cast<int>(PieceType::King)];
+        if (king.isEmpty()) continue; // Kingless test positions
+        const auto kingSquare = king.LSBIndex();
+        const auto them = !kingSide;
+
+        // Enemy sliders that would hit the king on an empty board. When exactly one piece stands
+        // in between, it blocks the ray for this king.
+        auto snipers =
+            (AttackTables::rookAttacks(kingSquare, BitBoard()) & state.orthoSliders[them]) |
+            (AttackTables::bishopAttacks(kingSquare, BitBoard()) & state.diagonalSliders[them]);
+        while (snipers) {
+            const auto sniper = snipers.popLSB().getIndex();
+            const auto blockers = AttackTables::betweenMasks[kingSquare][sniper] & occupancy;
+            if (blockers.popCount() != 1) continue;
+            checkInfoCache.blockersForKing[kingSide] |= blockers;
+            if (blockers & state.colorBitBoards[kingSide]) {
+                checkInfoCache.pinners[them] |= squareBB[sniper];
+            }
         }
-    }
 
-    // Check diagonal right
-    pawnCheckSquare = kingSquare.tryOffset(Offset(1, pawnAttackDir));
-    if (pawnCheckSquare != Square::None) {
-        const auto piece = getPieceAt(pawnCheckSquare);
-        if (piece.type == PieceType::Pawn && piece.side == enemy) {
-            return true;
+        if (kingSide == side) {
+            checkInfoCache.checkers =
+                attackersTo(kingSquare, occupancy) & state.colorBitBoards[them];
         }
     }
+    checkInfoValid = true;
+}
 
-    for (const auto& offset : AttackTables::knightOffsets) {
-        const auto knightCheckSquare = kingSquare.tryOffset(offset);
-        if (knightCheckSquare != Square::None) {
-            const auto piece = getPieceAt(knightCheckSquare);
-            if (piece.type == PieceType::Knight && piece.side == enemy) {
-                return true;
-            }
-        }
-    }
+namespace {
 
-    // Check for slider attacks (bishops, rooks, queens)
-    // Diagonal directions for bishop/queen
-    const Offset diagonalOffsets[] = {{-1, -1}, {-1, 1}, {1, -1}, {1, 1}};
+int seeValue(int pieceType) { return Evaluation::materialValues[pieceType]; }
 
-    for (const auto& offset : diagonalOffsets) {
-        auto checkSquare = kingSquare;
-        while (true) {
-            checkSquare = checkSquare.tryOffset(offset);
-            if (checkSquare == Square::None) break;
+// What the first move of an exchange does: the material it wins, the value of the piece it leaves
+// on the target square and the occupancy once it is played
+struct ExchangeStart {
+    int gain;
+    int pieceOnTarget;
+    BitBoard occupancy;
+};
 
-            Piece piece = getPieceAt(checkSquare);
-            if (piece.type != PieceType::None) {
-                if (Piece::isDiagonalSlider(piece) && piece.side == enemy) {
-                    return true;
-                }
-                break; // Blocked by a piece
-            }
-        }
+ExchangeStart startExchange(const BoardState& state, BitBoard occupancy, const Move move) {
+    const auto from = move.startSquareIndex();
+    const auto to = move.targetSquareIndex();
+    ExchangeStart start{0, seeValue(state.mailbox[from] % 6), occupancy ^ squareMask(from)};
+
+    if (move.isEnPassant()) {
+        start.gain = seeValue(static_cast<int>(PieceType::Pawn));
+        start.occupancy ^= squareMask((from & ~7) | (to & 7)); // The pawn next to the mover
+    } else if (state.mailbox[to] != BoardState::noPiece) {
+        start.gain = seeValue(state.mailbox[to] % 6);
     }
+    if (move.isPromotion()) {
+        start.pieceOnTarget = seeValue(static_cast<int>(move.getPromotionPieceType()));
+        start.gain += start.pieceOnTarget - seeValue(static_cast<int>(PieceType::Pawn));
+    }
+    return start;
+}
 
-    // Orthogonal directions for rook/queen
-    const Offset orthoOffsets[] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+// The least valuable of a side's attackers, as a single square bitboard; sets its piece type
+BitBoard leastValuableAttacker(const BoardState& state, BitBoard attackers, Side side,
+                               int& pieceType) {
+    for (pieceType = static_cast<int>(PieceType::Pawn);
+         pieceType < static_cast<int>(PieceType::King); ++pieceType) {
+        const auto pieces = attackers & state.piecesBitBoards[side * 6 + pieceType];
+        if (!pieces.isEmpty()) return squareMask(pieces.LSBIndex());
+    }
+    return squareMask((attackers & state.piecesBitBoards[side * 6 + pieceType]).LSBIndex());
+}
 
-    for (const auto& offset : orthoOffsets) {
-        auto checkSquare = kingSquare;
-        while (true) {
-            checkSquare = checkSquare.tryOffset(offset);
-            if (checkSquare == Square::None) break;
+// Sliders that attack the square through the piece of the given type that just left it. Pawns
+// capture diagonally, so only bishops and queens can stand behind them.
+BitBoard xRayAttackers(const BoardState& state, int square, BitBoard occupancy, int pieceType) {
+    const auto type = static_cast<PieceType>(pieceType);
+    BitBoard attackers;
+    if (type == PieceType::Pawn || type == PieceType::Bishop || type == PieceType::Queen) {
+        attackers |= AttackTables::bishopAttacks(square, occupancy) &
+                     (state.diagonalSliders[Side::White] | state.diagonalSliders[Side::Black]);
+    }
+    if (type == PieceType::Rook || type == PieceType::Queen) {
+        attackers |= AttackTables::rookAttacks(square, occupancy) &
+                     (state.orthoSliders[Side::White] | state.orthoSliders[Side::Black]);
+    }
+    return attackers;
+}
 
-            const auto piece = getPieceAt(checkSquare);
-            if (piece.type != PieceType::None) {
-                if (Piece::isOrthoSlider(piece) && piece.side == enemy) {
-                    return true;
-                }
-                break; // Blocked by a piece
-            }
+} // namespace
+
+int Board::see(const Move move) const {
+    if (move.getMoveFlag() == MoveFlag::CastleFlag) return 0;
+
+    const auto to = move.targetSquareIndex();
+    auto [firstGain, pieceOnTarget, occupied] = startExchange(currentState, occupancy(), move);
+    auto attackers = attackersTo(to, occupied);
+
+    // gain[d]: what the side making capture d has won if the exchange stops after it. Every
+    // capture removes a piece, so there are fewer than 32 of them.
+    std::array<int, 32> gain;
+    gain[0] = firstGain;
+    auto depth = 0;
+    for (auto stm = !side;; stm = !stm) {
+        attackers &= occupied;
+        auto stmAttackers = attackers & currentState.colorBitBoards[stm];
+        if (pinners(!stm) & occupied) stmAttackers &= ~blockersForKing(stm);
+        if (stmAttackers.isEmpty()) break;
+
+        int pieceType;
+        const auto attacker = leastValuableAttacker(currentState, stmAttackers, stm, pieceType);
+        if (pieceType == static_cast<int>(PieceType::King) &&
+            !(attackers & currentState.colorBitBoards[!stm]).isEmpty()) {
+            break;
         }
+
+        ++depth;
+        gain[depth] = pieceOnTarget - gain[depth - 1];
+        pieceOnTarget = seeValue(pieceType);
+        occupied ^= attacker;
+        attackers |= xRayAttackers(currentState, to, occupied, pieceType);
     }
 
-    // Check for king proximity (should not happen in a legal position, but checking for
-    // completeness)
+    // Going back up, each side only makes its capture if that beats stopping before it
+    for (; depth > 0; --depth) {
+        gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+    }
+    return gain[0];
+}
 
-    for (const auto& offset : AttackTables::kingOffsets) {
-        const auto kingCheckSquare = kingSquare.tryOffset(offset);
-        if (kingCheckSquare != Square::None) {
-            const auto piece = getPieceAt(kingCheckSquare);
-            if (piece.type == PieceType::King && piece.side == enemy) {
-                return true;
-            }
+bool Board::seeGE(const Move move, int threshold) const {
+    if (move.getMoveFlag() == MoveFlag::CastleFlag) return threshold <= 0;
+
+    const auto to = move.targetSquareIndex();
+    auto [firstGain, pieceOnTarget, occupied] = startExchange(currentState, occupancy(), move);
+
+    // swap is the margin over the threshold, seen from the side that just captured. Below zero
+    // after our capture we fail even if nothing is taken back, at most zero after their
+    // recapture we pass even if they lose the recapturing piece.
+    auto swap = firstGain - threshold;
+    if (swap < 0) return false;
+    swap = pieceOnTarget - swap;
+    if (swap <= 0) return true;
+
+    auto attackers = attackersTo(to, occupied);
+    auto result = true; // Whether we pass if the side that just captured is the last to do so
+    for (auto stm = !side;; stm = !stm) {
+        attackers &= occupied;
+        auto stmAttackers = attackers & currentState.colorBitBoards[stm];
+        if (pinners(!stm) & occupied) stmAttackers &= ~blockersForKing(stm);
+        if (stmAttackers.isEmpty()) break;
+
+        result = !result;
+        int pieceType;
+        const auto attacker = leastValuableAttacker(currentState, stmAttackers, stm, pieceType);
+        if (pieceType == static_cast<int>(PieceType::King)) {
+            // The king only takes if nothing can take it back
+            return (attackers & currentState.colorBitBoards[!stm]).isEmpty() ? result : !result;
         }
-    }
 
-    // No check detected
-    return false;
+        swap = seeValue(pieceType) - swap;
+        if (swap < static_cast<int>(result)) break;
+        occupied ^= attacker;
+        attackers |= xRayAttackers(currentState, to, occupied, pieceType);
+    }
+    return result;
 }
 
-bool Board::isInCheck() {
-    // Use cached value if available
-    inCheckCache = calculateInCheckState();
-    return inCheckCache;
+bool Board::isConsistent() const {
+    BitBoard occupancy;
+    for (int index = 0; index < 64; ++index) {
+        const auto pieceIndex = currentState.mailbox[index];
+        for (int i = 0; i < 12; ++i) {
+            if (currentState.piecesBitBoards[i].contains(Square(index)) != (pieceIndex == i)) {
+                return false;
+            }
+        }
+        if (pieceIndex == BoardState::noPiece) continue;
+
+        const Piece piece(static_cast<int>(pieceIndex));
+        if (!currentState.colorBitBoards[piece.side].contains(Square(index)) ||
+            currentState.colorBitBoards[!piece.side].contains(Square(index))) {
+            return false;
+        }
+        occupancy.set(Square(index));
+    }
+    return occupancy ==
+           (currentState.colorBitBoards[Side::White] | currentState.colorBitBoards[Side::Black]);
 }
 
 // Implementation of Board diagram creation
@@ -421,7 +597,8 @@ const std::string Board::createDiagram(const Board& board, const bool blackAtTop
     std::ostringstream ss;
 
     // Get the last move's target square for highlighting (if available)
-    Square lastMoveSquare = board.undoHistory.size() > 0 ? board.undoHistory.back().to : -1;
+    const auto lastMove = board.lastMove();
+    Square lastMoveSquare = lastMove.isNull() ? Square() : lastMove.to();
 
     // Board frame top
     ss << "  ┌────────────────────────┐\n";
@@ -508,7 +685,7 @@ const std::string Board::createDiagram(const Board& board, const bool blackAtTop
     return ss.str();
 }
 
-std::vector<Move> Board::generateLegalMoves() {
+MoveList Board::generateLegalMoves() {
     MoveGenerator moveGenerator(*this);
     return moveGenerator.generateMoves();
 }
@@ -522,68 +699,33 @@ Square Board::findKingSquare(Side side) const {
     return Square::None;
 }
 
-// Redundant with moveGen IsSquareAttacked??
-bool Board::isSquareAttacked(Square square, Side attackerSide) const {
-    const int sq = square.getIndex();
-    const BitBoard squareBB(1ULL << sq);
-
-    // Check pawn attacks using pre-computed tables
-    const auto pawnBB =
-        currentState.piecesBitBoards[attackerSide * 6 + static_cast<int>(PieceType::Pawn)];
-    const auto& pawnAttacks = (attackerSide == Side::White) ? AttackTables::whitePawnAttacks[sq]
-                                                            : AttackTables::blackPawnAttacks[sq];
-    if (pawnAttacks & pawnBB) return true;
-
-    // Check knight attacks using pre-computed tables
-    const auto knightBB =
-        currentState.piecesBitBoards[attackerSide * 6 + static_cast<int>(PieceType::Knight)];
-    if (AttackTables::knightAttacks[sq] & knightBB) return true;
-
-    // Check king attacks using pre-computed tables
-    const auto kingBB =
-        currentState.piecesBitBoards[attackerSide * 6 + static_cast<int>(PieceType::King)];
-    if (AttackTables::kingAttacks[sq] & kingBB) return true;
-
-    // Get all occupancy for sliding piece attacks
-    const BitBoard occupancy =
-        currentState.colorBitBoards[Side::White] | currentState.colorBitBoards[Side::Black];
-
-    // Check diagonal sliders (bishops and queens)
-    const BitBoard diagonalSliders = currentState.diagonalSliders[attackerSide];
-    if (diagonalSliders) {
-        BitBoard bishopAttacks;
-        for (const auto& dir : AttackTables::bishopOffsets) {
-            auto current = square;
-            while (true) {
-                current = current.tryOffset(dir);
-                if (current == Square::None) break;
-                bishopAttacks.set(current);
-                if (occupancy.contains(current)) break;
-            }
-        }
-        if (bishopAttacks & diagonalSliders) return true;
-    }
-
-    // Check orthogonal sliders (rooks and queens)
-    const BitBoard orthoSliders = currentState.orthoSliders[attackerSide];
-    if (orthoSliders) {
-        BitBoard rookAttacks;
-        for (const auto& dir : AttackTables::rookOffsets) {
-            auto current = square;
-            while (true) {
-                current = current.tryOffset(dir);
-                if (current == Square::None) break;
-                rookAttacks.set(current);
-                if (occupancy.contains(current)) break;
-            }
-        }
-        if (rookAttacks & orthoSliders) return true;
+namespace {
+
+void printPerftResults(int depth, uint64_t nodes, double seconds, Board::PerftMode mode,
+                       const PerftTable* table, std::size_t threads) {
+    const double nodesPerSecond = (seconds > 0) ? nodes / seconds : nodes;
+
+    std::cout << "\n=== Perft Results for Depth " << depth << " ===\n";
+    const char* modeName = mode == Board::PerftMode::BulkCount    ? "bulk count"
+                           : mode == Board::PerftMode::MakeUnmake ? "make/unmake"
+                                                                  : "copy-make";
+    std::cout << "Mode: " << modeName << ", " << threads << (threads == 1 ? " thread" : " threads") << "\n";
+    std::cout << "Total Nodes: " << nodes << "\n";
+    std::cout << "Time Taken: " << std::fixed << std::setprecision(6) << seconds * 1000 << " ms\n";
+    std::cout << "Nodes per Second: " << std::fixed << std::setprecision(0) << nodesPerSecond
+              << " nps"
+              << "\n";
+    if (table) {
+        std::cout << "Hash: " << table->sizeInBytes() / (1024 * 1024) << " MB, " << table->hits()
+                  << " hits / " << table->probes() << " probes (" << std::setprecision(2)
+                  << table->hitRate() * 100 << "%)\n";
     }
-
-    return false;
+    std::cout << "================================\n";
 }
 
-uint64_t Board::perft(int depth, bool verbose) {
+} // namespace
+
+uint64_t Board::perft(int depth, bool verbose, PerftMode mode, PerftTable* table) {
     if (depth == 0) return 1;
 
     std::chrono::high_resolution_clock::time_point start;
@@ -591,60 +733,138 @@ uint64_t Board::perft(int depth, bool verbose) {
         start = std::chrono::high_resolution_clock::now();
     }
 
-    MoveGenerator moveGen(*this);
-    auto moves = moveGen.generatePseudoLegalMoves();
+    PerftTable::Counters counters;
+    const auto nodes = countPerftLeaves(depth, mode, table, counters);
+    if (table) table->addCounters(counters);
+
+    if (verbose) {
+        const std::chrono::duration<double> duration =
+            std::chrono::high_resolution_clock::now() - start;
+        printPerftResults(depth, nodes, duration.count(), mode, table, 1);
+    }
 
+    return nodes;
+}
+
+uint64_t Board::countPerftLeaves(int depth, PerftMode mode, PerftTable* table,
+                                 PerftTable::Counters& counters) {
+    if (depth == 0) return 1;
+
+    // Depth 1 is cheaper to recount than to look up
+    const auto useTable = table != nullptr && depth >= 2;
     uint64_t nodes = 0;
-    Side movingSide = side;
+    if (!useTable || !table->probe(zobristKey, depth, nodes, counters)) {
+        MoveGenerator moveGen(*this);
+        const auto moves = moveGen.generateMoves();
+
+        // The generator is fully legal, so the leaves one ply down are just the moves in the list
+        if (depth == 1 && mode == PerftMode::BulkCount) {
+            nodes = moves.size();
+        } else if (mode == PerftMode::CopyMake) {
+            // This frame's copy is the per-ply stack entry
+            const Position saved = *this;
+            for (const auto& move : moves) {
+                makeMove(move);
+                nodes += countPerftLeaves(depth - 1, mode, table, counters);
+                restore(saved);
+            }
+        } else {
+            for (const auto& move : moves) {
+                makeMove(move);
+                nodes += countPerftLeaves(depth - 1, mode, table, counters);
+                unMakeMove(move);
+            }
+        }
 
-    for (const auto& move : moves) {
-        auto undoInfo = makeMove(move.from(), move.to());
-        Square kingSquare = findKingSquare(movingSide);
-        if (!isSquareAttacked(kingSquare, side)) {
-            nodes += perft(depth - 1);
+        if (useTable) table->store(zobristKey, depth, nodes);
+    }
+    return nodes;
+}
+
+uint64_t Board::parallelPerft(int depth, std::size_t threads, bool verbose, PerftMode mode,
+                              PerftTable* table) {
+    if (depth == 0) return 1;
+    if (threads <= 1) return perft(depth, verbose, mode, table);
+
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    // Split the tree into subtrees, one ply at a time, until there are enough tasks to keep every
+    // worker busy while the slow ones finish. Always leave at least one ply for the workers.
+    const auto taskTarget = threads * 16;
+    std::vector<std::vector<Move>> paths(1);
+    int splitDepth = 0;
+    while (splitDepth < depth - 1 && paths.size() < taskTarget) {
+        std::vector<std::vector<Move>> children;
+        for (const auto& path : paths) {
+            for (const auto& move : path) {
+                makeMove(move);
+            }
+            // Terminal positions have no leaves below them and simply drop out
+            for (const auto& move : generateLegalMoves()) {
+                children.push_back(path);
+                children.back().push_back(move);
+            }
+            for (auto i = path.size(); i-- > 0;) {
+                unMakeMove(path[i]);
+            }
         }
-        unMakeMove(move.from(), move.to(), undoInfo);
+        paths = std::move(children);
+        ++splitDepth;
     }
 
-    if (verbose) {
-        auto end = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double> duration = end - start;
-        double seconds = duration.count();
-        double nodesPerSecond = (seconds > 0) ? nodes / seconds : nodes;
+    // Each worker plays its paths on its own copy of the board. Every task adds its table counters
+    // to the totals once, in perft().
+    std::vector<Board> boards(threads, *this);
+    std::vector<uint64_t> counts(paths.size(), 0);
+    {
+        WorkStealingPool pool(threads);
+        for (std::size_t i = 0; i < paths.size(); ++i) {
+            pool.submit([&, i](std::size_t worker) {
+                auto& board = boards[worker];
+                const auto& path = paths[i];
+                for (const auto& move : path) {
+                    board.makeMove(move);
+                }
+                counts[i] = board.perft(depth - splitDepth, false, mode, table);
+                for (auto j = path.size(); j-- > 0;) {
+                    board.unMakeMove(path[j]);
+                }
+            });
+        }
+        pool.wait();
+    }
 
-        std::cout << "\n=== Perft Results for Depth " << depth << " ===\n";
-        std::cout << "Total Nodes: " << nodes << "\n";
-        std::cout << "Time Taken: " << std::fixed << std::setprecision(6) << seconds * 1000
-                  << " ms\n";
-        std::cout << "Nodes per Second: " << std::fixed << std::setprecision(0) << nodesPerSecond
-                  << " nps"
-                  << "\n";
-        std::cout << "================================\n";
+    uint64_t nodes = 0;
+    for (const auto count : counts) {
+        nodes += count;
+    }
+
+    if (verbose) {
+        const std::chrono::duration<double> duration =
+            std::chrono::high_resolution_clock::now() - start;
+        printPerftResults(depth, nodes, duration.count(), mode, table, threads);
     }
 
     return nodes;
 }
 
-void Board::perftDivide(int depth) {
+void Board::perftDivide(int depth, PerftMode mode) {
     if (depth <= 0) {
         std::cout << "Depth must be greater than 0\n";
         return;
     }
 
     MoveGenerator moveGen(*this);
-    auto moves = moveGen.generatePseudoLegalMoves();
+    const auto moves = moveGen.generateMoves();
     uint64_t totalNodes = 0;
-    Side movingSide = side;
 
     std::cout << "\n=== Perft Divide at Depth " << depth << " ===\n";
     for (const auto& move : moves) {
-        auto undoInfo = makeMove(move.from(), move.to());
-        if (!isSquareAttacked(findKingSquare(movingSide), side)) {
-            uint64_t nodes = perft(depth - 1);
-            totalNodes += nodes;
-            std::cout << static_cast<std::string>(move) << ": " << nodes << "\n";
-        }
-        unMakeMove(move.from(), move.to(), undoInfo);
+        makeMove(move);
+        const uint64_t nodes = perft(depth - 1, false, mode);
+        totalNodes += nodes;
+        std::cout << static_cast<std::string>(move) << ": " << nodes << "\n";
+        unMakeMove(move);
     }
     std::cout << "Total Moves: " << moves.size() << "\n";
     std::cout << "Total Nodes: " << totalNodes << "\n";
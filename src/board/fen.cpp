@@ -6,12 +6,14 @@
 void FEN::parse(const std::string& fen, Board& board) {
     board.currentState.colorBitBoards.fill(BitBoard());
     board.currentState.piecesBitBoards.fill(0);
+    board.currentState.mailbox.fill(BoardState::noPiece);
     board.side = Side::White;
     board.castlingRights = 0;
     board.enPassantSquare = std::nullopt;
     board.halfMoveClock = 0;
     board.fullMoveClock = 1;
-    board.inCheckCache = false;
+    board.zobristKey = 0;
+    board.undoCount = 0; // A new position has no moves to take back
 
     std::istringstream fenStream(fen);
     std::string boardPart, activeColor, castling, enPassant, halfMove, fullMove;
@@ -26,6 +28,7 @@ void FEN::parse(const std::string& fen, Board& board) {
     board.fullMoveClock = parseFullMoveNumber(fullMove);
 
     board.updateSliderBitboards();
+    board.zobristKey = board.computeZobristKey();
 }
 
 std::string FEN::generate(const Board& board) {
@@ -53,8 +56,7 @@ void FEN::parsePiecePlacement(const std::string& placement, Board& board) {
             Square sq(file, rank);
             Piece piece(c);
 
-            board.currentState.piecesBitBoards[piece.pieceIndex()].set(sq);
-            board.currentState.colorBitBoards[piece.side].set(sq);
+            board.putPiece(piece, sq);
             file++;
         }
     }
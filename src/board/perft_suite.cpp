@@ -0,0 +1,175 @@
+#include "board/perft_suite.hpp"
+#include "threading/work_stealing_pool.hpp"
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace PerftSuite {
+
+namespace {
+
+double nodesPerSecond(uint64_t nodes, double seconds) {
+    return seconds > 0 ? static_cast<double>(nodes) / seconds : 0.0;
+}
+
+// Valid FEN strings only contain characters that are safe inside JSON and CSV strings, but
+// malformed ones and the errors about them may hold anything
+std::string quoted(const std::string& text) {
+    std::string result = "\"";
+    for (const char c : text) {
+        if (c == '"' || c == '\\') result += '\\';
+        result += c;
+    }
+    return result + "\"";
+}
+
+} // namespace
+
+bool Result::passed() const {
+    if (!error.empty()) return false;
+    for (const auto& depth : depths) {
+        if (!depth.passed()) return false;
+    }
+    return true;
+}
+
+uint64_t Result::nodes() const {
+    uint64_t total = 0;
+    for (const auto& depth : depths) total += depth.nodes;
+    return total;
+}
+
+double Result::seconds() const {
+    double total = 0;
+    for (const auto& depth : depths) total += depth.seconds;
+    return total;
+}
+
+Entry parseLine(const std::string& line) {
+    Entry entry;
+    std::istringstream fields(line);
+    std::string field;
+
+    std::getline(fields, field, ';');
+    std::istringstream fenFields(field);
+    std::string token;
+    std::vector<std::string> tokens;
+    while (fenFields >> token) tokens.push_back(token);
+    if (tokens.size() < 4) throw std::invalid_argument("EPD line without a full position: " + line);
+    // EPD positions usually leave out the halfmove clock and fullmove number
+    if (tokens.size() == 4) {
+        tokens.push_back("0");
+        tokens.push_back("1");
+    }
+    for (std::size_t i = 0; i < tokens.size(); ++i) {
+        entry.fen += (i ? " " : "") + tokens[i];
+    }
+
+    while (std::getline(fields, field, ';')) {
+        std::istringstream depthField(field);
+        std::string name;
+        uint64_t nodes = 0;
+        if (!(depthField >> name)) continue;
+        if (name.size() < 2 || name[0] != 'D' || !(depthField >> nodes)) {
+            throw std::invalid_argument("Malformed EPD depth entry '" + field + "' in: " + line);
+        }
+        entry.expected.emplace_back(std::stoi(name.substr(1)), nodes);
+    }
+    return entry;
+}
+
+std::vector<Entry> parse(std::istream& input) {
+    std::vector<Entry> entries;
+    std::string line;
+    while (std::getline(input, line)) {
+        const auto first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') continue;
+        entries.push_back(parseLine(line));
+    }
+    return entries;
+}
+
+std::vector<Result> run(const std::vector<Entry>& entries, int maxDepth, std::size_t threads,
+                        Board::PerftMode mode) {
+    std::vector<Result> results(entries.size());
+
+    // One task per position; each builds its own board so the workers share nothing
+    WorkStealingPool pool(threads);
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        pool.submit([&, i](std::size_t) {
+            const auto& entry = entries[i];
+            auto& result = results[i];
+            result.fen = entry.fen;
+
+            // An exception must not escape a pool thread, it would terminate the process
+            try {
+                Board board(entry.fen);
+                for (const auto& [depth, expected] : entry.expected) {
+                    if (maxDepth > 0 && depth > maxDepth) continue;
+                    const auto start = std::chrono::steady_clock::now();
+                    const auto nodes = board.perft(depth, false, mode);
+                    const std::chrono::duration<double> elapsed =
+                        std::chrono::steady_clock::now() - start;
+                    result.depths.push_back({depth, expected, nodes, elapsed.count()});
+                }
+            } catch (const std::exception& e) {
+                result.error = e.what();
+            }
+        });
+    }
+    pool.wait();
+
+    return results;
+}
+
+void writeJson(std::ostream& output, const std::vector<Result>& results, double wallSeconds) {
+    uint64_t totalNodes = 0;
+    std::size_t failed = 0;
+
+    output << std::fixed << "{\n  \"positions\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const auto& result = results[i];
+        totalNodes += result.nodes();
+        if (!result.passed()) ++failed;
+
+        output << "    {\"fen\": " << quoted(result.fen)
+               << ", \"passed\": " << (result.passed() ? "true" : "false")
+               << ", \"nodes\": " << result.nodes() << ", \"time_ms\": " << std::setprecision(3)
+               << result.seconds() * 1000 << ", \"nps\": " << std::setprecision(0)
+               << nodesPerSecond(result.nodes(), result.seconds());
+        if (!result.error.empty()) output << ", \"error\": " << quoted(result.error);
+        output << ", \"depths\": [";
+        for (std::size_t j = 0; j < result.depths.size(); ++j) {
+            const auto& depth = result.depths[j];
+            output << (j ? ", " : "") << "{\"depth\": " << depth.depth
+                   << ", \"expected\": " << depth.expected << ", \"nodes\": " << depth.nodes
+                   << ", \"time_ms\": " << std::setprecision(3) << depth.seconds * 1000
+                   << ", \"nps\": " << std::setprecision(0)
+                   << nodesPerSecond(depth.nodes, depth.seconds)
+                   << ", \"passed\": " << (depth.passed() ? "true" : "false") << "}";
+        }
+        output << "]}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    output << "  ],\n  \"summary\": {\"positions\": " << results.size()
+           << ", \"failed\": " << failed << ", \"nodes\": " << totalNodes
+           << ", \"wall_time_ms\": " << std::setprecision(3) << wallSeconds * 1000
+           << ", \"nps\": " << std::setprecision(0) << nodesPerSecond(totalNodes, wallSeconds)
+           << "}\n}\n";
+}
+
+void writeCsv(std::ostream& output, const std::vector<Result>& results) {
+    output << std::fixed << "fen,depth,expected,nodes,passed,time_ms,nps\n";
+    for (const auto& result : results) {
+        // A position that could not be run still gets a (failed) row
+        if (!result.error.empty()) output << quoted(result.fen) << ",,,,false,,\n";
+        for (const auto& depth : result.depths) {
+            output << quoted(result.fen) << "," << depth.depth << "," << depth.expected << ","
+                   << depth.nodes << "," << (depth.passed() ? "true" : "false") << ","
+                   << std::setprecision(3) << depth.seconds * 1000 << "," << std::setprecision(0)
+                   << nodesPerSecond(depth.nodes, depth.seconds) << "\n";
+        }
+    }
+}
+
+} // namespace PerftSuite
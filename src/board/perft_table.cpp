@@ -0,0 +1,60 @@
+#include "board/perft_table.hpp"
+#include <algorithm>
+#include <bit>
+
+PerftTable::PerftTable(std::size_t megabytes) {
+    const auto bytes = std::max<std::size_t>(megabytes, 1) * 1024 * 1024;
+    bucketCount = std::bit_floor(bytes / sizeof(Bucket));
+    buckets = std::make_unique<Bucket[]>(bucketCount);
+}
+
+bool PerftTable::probe(uint64_t key, int depth, uint64_t& nodes, Counters& counters) const {
+    ++counters.probes;
+
+    auto& bucket = bucketFor(key);
+    for (auto* entry : {&bucket.deepest, &bucket.recent}) {
+        const auto data = entry->data.load(std::memory_order_relaxed);
+        if ((entry->check.load(std::memory_order_relaxed) ^ data) != key) continue;
+        if (static_cast<int>(data & depthMask) != depth) continue;
+
+        nodes = data >> 8;
+        ++counters.hits;
+        return true;
+    }
+    return false;
+}
+
+void PerftTable::store(uint64_t key, int depth, uint64_t nodes) {
+    auto& bucket = bucketFor(key);
+    const auto data = nodes << 8 | static_cast<uint64_t>(depth);
+
+    // Deeper subtrees save more work on a hit, so they get the slot that is not always replaced
+    auto& deepest = bucket.deepest;
+    auto* entry = &bucket.recent;
+    if (static_cast<int>(deepest.data.load(std::memory_order_relaxed) & depthMask) <= depth) {
+        entry = &deepest;
+    }
+    entry->check.store(key ^ data, std::memory_order_relaxed);
+    entry->data.store(data, std::memory_order_relaxed);
+}
+
+void PerftTable::clear() {
+    for (std::size_t i = 0; i < bucketCount; ++i) {
+        for (auto* entry : {&buckets[i].deepest, &buckets[i].recent}) {
+            entry->check.store(0, std::memory_order_relaxed);
+            entry->data.store(0, std::memory_order_relaxed);
+        }
+    }
+    probeCount.store(0, std::memory_order_relaxed);
+    hitCount.store(0, std::memory_order_relaxed);
+}
+
+void PerftTable::addCounters(const Counters& counters) {
+    probeCount.fetch_add(counters.probes, std::memory_order_relaxed);
+    hitCount.fetch_add(counters.hits, std::memory_order_relaxed);
+}
+
+double PerftTable::hitRate() const {
+    const auto total = probes();
+    return total ? static_cast<double>(hits()) / static_cast<double>(total) : 0.0;
+}
@@ -0,0 +1,69 @@
+#include "engine/bench.hpp"
+#include "board/board.hpp"
+#include "moves/search/search.hpp"
+#include <array>
+#include <chrono>
+#include <iomanip>
+#include <string_view>
+
+namespace Bench {
+
+namespace {
+
+struct BenchPosition {
+    std::string_view fen;
+    int perftDepth;
+    int searchDepth;
+};
+
+// Never change these without noting the new signature in the commit message
+constexpr std::array<BenchPosition, 6> positions = {{
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 5, 5},
+    {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 5},
+    {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 5},
+    {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4, 5},
+    {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 5},
+    {"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, 5},
+}};
+
+} // namespace
+
+Result run(std::ostream& output) {
+    Result result{0, 0.0};
+    TranspositionTable table(16);
+
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+        const auto& position = positions[i];
+        Board board{std::string(position.fen)};
+
+        // Full make/unmake so the bench also times makeMove/unMakeMove, not only generation
+        const auto start = std::chrono::steady_clock::now();
+        const auto nodes = board.perft(position.perftDepth, false, Board::PerftMode::MakeUnmake);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        result.nodes += nodes;
+        result.seconds += elapsed.count();
+        output << "Position " << i + 1 << "/" << positions.size() << " perft " << position.perftDepth
+               << ": " << nodes << " nodes  " << position.fen << "\n";
+
+        // Fixed depth, no time or node limit and an empty table, so the search nodes are part of
+        // the signature
+        table.clear();
+        const auto search = Search(board, &table).run({.depth = position.searchDepth});
+        result.nodes += search.nodes;
+        result.seconds += search.seconds;
+        output << "Position " << i + 1 << "/" << positions.size() << " search "
+               << position.searchDepth << ": " << Search::formatIteration(search) << "\n";
+    }
+
+    output << "\n===========================\n";
+    output << "Total time (ms) : " << std::fixed << std::setprecision(0) << result.seconds * 1000
+           << "\n";
+    output << "Nodes searched  : " << result.nodes << "\n";
+    output << "Nodes/second    : " << std::fixed << std::setprecision(0)
+           << result.nodesPerSecond() << "\n";
+
+    return result;
+}
+
+} // namespace Bench
@@ -1,7 +1,77 @@
 
 #include "board/board.hpp"
+#include "engine/bench.hpp"
+#include "moves/search/search.hpp"
+#include <cstdlib>
+#include <iostream>
 #include <string>
-int main() {
+
+namespace {
+
+/**
+ * @brief `search [--depth <N>] [--nodes <N>] [--time <ms>] [--hash <MB>] [--threads <N>]
+ * [--split] [fen]`: prints one info line per iteration, then the best move. Without any limit it
+ * stops at depth 6; the transposition table defaults to 16 MB and the search to one thread.
+ * `--split` shares out the threads at split points instead of running Lazy SMP.
+ */
+int runSearch(int argc, char* argv[]) {
+    SearchLimits limits{.depth = 6};
+    std::size_t hashMegabytes = 16;
+    std::size_t threads = 1;
+    auto mode = ParallelMode::LazySmp;
+    std::string fen = Board::startPositionFen;
+    for (int i = 0; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const auto hasValue = i + 1 < argc;
+        if (arg == "--depth" && hasValue) {
+            limits.depth = std::atoi(argv[++i]);
+        } else if (arg == "--nodes" && hasValue) {
+            limits.nodes = std::strtoull(argv[++i], nullptr, 10);
+            limits.depth = Search::maxPly;
+        } else if (arg == "--time" && hasValue) {
+            limits.time = std::chrono::milliseconds(std::strtoull(argv[++i], nullptr, 10));
+            limits.depth = Search::maxPly;
+        } else if (arg == "--hash" && hasValue) {
+            hashMegabytes = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--threads" && hasValue) {
+            threads = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--split") {
+            mode = ParallelMode::SplitPoints;
+        } else {
+            fen = arg;
+        }
+    }
+
+    try {
+        Board board(fen);
+        TranspositionTable table(hashMegabytes);
+        const auto printIteration = [](const SearchIteration& iteration) {
+            std::cout << Search::formatIteration(iteration) << "\n";
+        };
+        const auto result = Search(board, &table, threads, mode).run(limits, printIteration);
+        std::cout << "info string qnodes " << result.qnodes << " of " << result.nodes << " nodes\n";
+        std::cout << "bestmove " << (result.pv.empty() ? "(none)" : Search::uciMove(result.pv[0]))
+                  << "\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Error: Invalid FEN or board setup: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    // `schmetterling_exec bench` prints a node signature and NPS for a fixed set of positions
+    if (argc > 1 && std::string(argv[1]) == "bench") {
+        Bench::run(std::cout);
+        return 0;
+    }
+    // `schmetterling_exec search` analyses a position, see runSearch()
+    if (argc > 1 && std::string(argv[1]) == "search") {
+        return runSearch(argc - 2, argv + 2);
+    }
+
     // Initialize board with standard chess position
     std::string initialFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
     Board board(initialFen);
@@ -33,13 +103,13 @@ int main() {
                   << "\n";
 
         // Make the move
-        auto undoInfo = board.makeMove(fromSq, toSq);
+        board.makeMove(fromSq, toSq);
         //
         // // Print the board after the move
         std::cout << Board::createDiagram(board, true, true);
         //
         // // Test unmaking the move (to verify state restoration)
-        board.unMakeMove(fromSq, toSq, undoInfo);
+        board.unMakeMove(Move(fromSq.getIndex(), toSq.getIndex()));
         board.makeMove(fromSq, toSq); // Reapply the move to continue the game
     }
 
@@ -0,0 +1,141 @@
+#include "moves/generation/attack_squares.hpp"
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
+namespace AttackTables {
+
+namespace {
+
+using SliderTable = std::array<BitBoard, sliderTableSize>;
+
+// Plain (non constexpr) builders: given a constexpr-capable initializer, GCC first tries to
+// constant-evaluate the whole table and gives up only after tens of seconds of compile time.
+
+/**
+ * @brief Fills the block of every square by enumerating all subsets of its relevant mask
+ * (Carry-Rippler trick) and storing the ray-walked attacks at the magic index of that subset.
+ */
+void fillMagicBlocks(SliderTable& table, const std::array<Magic, 64>& magics,
+                     const Offset (&directions)[4]) {
+    for (int square = 0; square < 64; ++square) {
+        const auto& magic = magics[square];
+        uint64_t subset = 0;
+        do {
+            table[magic.index(subset)] = computeSlidingAttacks(square, subset, directions);
+            subset = (subset - magic.mask) & magic.mask;
+        } while (subset);
+    }
+}
+
+/**
+ * @brief Fills the PEXT blocks. Slot i of a block holds the attacks for the occupancy whose relevant
+ * bits, read in mask order, spell i. Built with the software deposit so it works on any CPU.
+ */
+void fillPextBlocks(SliderTable& table, const std::array<Magic, 64>& magics,
+                    const Offset (&directions)[4]) {
+    for (int square = 0; square < 64; ++square) {
+        const auto& magic = magics[square];
+        const auto blockSize = 1ULL << magic.mask.popCount();
+        for (uint64_t index = 0; index < blockSize; ++index) {
+            const BitBoard occupancy(depositBits(index, magic.mask));
+            table[magic.offset + index] = computeSlidingAttacks(square, occupancy, directions);
+        }
+    }
+}
+
+SliderTable buildMagicTable() {
+    SliderTable table{};
+    fillMagicBlocks(table, bishopMagics, bishopOffsets);
+    fillMagicBlocks(table, rookMagics, rookOffsets);
+    return table;
+}
+
+void buildPextTable() {
+    static std::once_flag built;
+    std::call_once(built, [] {
+        fillPextBlocks(pextAttackTable, bishopMagics, bishopOffsets);
+        fillPextBlocks(pextAttackTable, rookMagics, rookOffsets);
+    });
+}
+
+SliderBackend initialSliderBackend() {
+    const auto backend = detectSliderBackend();
+    if (backend == SliderBackend::Pext) buildPextTable();
+    return backend;
+}
+
+} // namespace
+
+const std::array<BitBoard, sliderTableSize> sliderAttackTable = buildMagicTable();
+std::array<BitBoard, sliderTableSize> pextAttackTable{};
+
+SliderBackend sliderBackend = initialSliderBackend();
+
+bool cpuSupportsBmi2() {
+#if defined(__x86_64__)
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    // Leaf 7, subleaf 0: structured extended feature flags, BMI2 is EBX bit 8
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return false;
+    return (ebx & (1U << 8)) != 0;
+#else
+    return false;
+#endif
+}
+
+bool pextIsFast(std::string_view vendor, unsigned family) {
+    if (vendor == "AuthenticAMD") return family >= 0x19;
+    return vendor != "HygonGenuine";
+}
+
+bool cpuHasFastPext() {
+#if defined(__x86_64__)
+    if (!cpuSupportsBmi2()) return false;
+
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    // Leaf 0: the vendor string is spelled by EBX, EDX, ECX
+    if (!__get_cpuid(0, &eax, &ebx, &ecx, &edx)) return false;
+    char vendor[12];
+    std::memcpy(vendor, &ebx, 4);
+    std::memcpy(vendor + 4, &edx, 4);
+    std::memcpy(vendor + 8, &ecx, 4);
+
+    // Leaf 1: EAX bits 8-11 are the family, extended by bits 20-27 when they read 0xF
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return false;
+    auto family = (eax >> 8) & 0xF;
+    if (family == 0xF) family += (eax >> 20) & 0xFF;
+    return pextIsFast(std::string_view(vendor, sizeof(vendor)), family);
+#else
+    return false;
+#endif
+}
+
+SliderBackend detectSliderBackend() {
+    return cpuHasFastPext() ? SliderBackend::Pext : SliderBackend::Magic;
+}
+
+void setSliderBackend(SliderBackend backend) {
+    if (backend == SliderBackend::Pext) {
+        if (!cpuSupportsBmi2()) {
+            throw std::runtime_error("PEXT slider backend requires a CPU with BMI2");
+        }
+        buildPextTable();
+    }
+    sliderBackend = backend;
+}
+
+const char* sliderBackendName(SliderBackend backend) {
+    switch (backend) {
+    case SliderBackend::Pext:
+        return "pext";
+    case SliderBackend::Magic:
+    default:
+        return "magic";
+    }
+}
+
+} // namespace AttackTables
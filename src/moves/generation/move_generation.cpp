@@ -2,105 +2,420 @@
 #include "board/types.hpp"
 #include "moves/generation/attack_squares.hpp"
 #include "moves/moves.hpp"
-#include <vector>
 
-#include <numeric>
-#include <vector>
+MoveList MoveGenerator::generateMoves() { return generate<GenType::Legal>(); }
 
-const std::vector<Move> MoveGenerator::generateMoves() {
-    _legalMoves.clear();
+template <GenType Type> MoveList MoveGenerator::generate() {
+    return (_board.side == Side::White) ? generateFor<Side::White, Type>()
+                                        : generateFor<Side::Black, Type>();
+}
+
+template <Side::Value Us, GenType Type> MoveList MoveGenerator::generateFor() const {
+    MoveList moves;
+    auto context = computeLegalContext<Us>();
+
+    if constexpr (Type == GenType::Evasions) {
+        if (!context.checkers) return moves;
+    }
+    if constexpr (Type == GenType::QuietChecks) {
+        computeCheckSquares<Us>(context);
+    }
+
+    // In double check only the king can move
+    if (context.checkers.popCount() < 2) {
+        generateLegalPawnMoves<Us, Type>(context, moves);
+        generateLegalPieceMoves<Us, Type>(context, moves);
+    }
+    generateLegalKingMoves<Us, Type>(context, moves);
+
+    return moves;
+}
+
+template <Side::Value Us> MoveGenerator::LegalContext MoveGenerator::computeLegalContext() const {
+    constexpr auto Them = Side::opposite(Us);
+    const auto& state = _board.currentState;
+
+    LegalContext context{};
+    context.own = state.colorBitBoards[Us];
+    context.enemy = state.colorBitBoards[Them];
+    context.occupancy = context.own | context.enemy;
+    context.checkMask = BitBoard(~0ULL);
+
+    const auto king = state.piecesBitBoards[Us * 6 + static_cast<int>(PieceType::King)];
+    if (king.isEmpty()) {
+        // Kingless test positions: nothing can be in check or pinned
+        context.kingSquare = -1;
+        return context;
+    }
+    context.kingSquare = king.LSBIndex();
+    const auto kingSquare = context.kingSquare;
+
+    // The board computes checkers and pins once per position, whichever caller asks first
+    context.checkers = _board.checkers();
+    if (context.checkers.popCount() == 1) {
+        // Capture the checker or block its ray
+        const auto checker = context.checkers.LSBIndex();
+        context.checkMask = AttackTables::betweenMasks[kingSquare][checker] | context.checkers;
+    }
+    context.pinned = _board.blockersForKing(Us) & context.own;
+
+    return context;
+}
+
+/**
+ * @brief Fills the squares from which each of our piece types would attack the enemy king, and the
+ * pieces standing between one of our sliders and that king. A quiet move checks if it lands on a
+ * check square of its piece type, or if a discoverer leaves the line to the king.
+ */
+template <Side::Value Us> void MoveGenerator::computeCheckSquares(LegalContext& context) const {
+    constexpr auto Them = Side::opposite(Us);
+    const auto& state = _board.currentState;
+
+    const auto enemyKing = state.piecesBitBoards[Them * 6 + static_cast<int>(PieceType::King)];
+    if (enemyKing.isEmpty()) {
+        context.enemyKingSquare = -1;
+        return;
+    }
+    const auto kingSquare = enemyKing.LSBIndex();
+    context.enemyKingSquare = kingSquare;
+
+    // Our pawn attacks the king from where one of their pawns on the king square would attack
+    const auto& theirPawnAttacks = AttackTables::pawnAttacks<Them>();
+    const auto bishopChecks = AttackTables::bishopAttacks(kingSquare, context.occupancy);
+    const auto rookChecks = AttackTables::rookAttacks(kingSquare, context.occupancy);
+    context.checkSquares[static_cast<int>(PieceType::Pawn)] = theirPawnAttacks[kingSquare];
+    context.checkSquares[static_cast<int>(PieceType::Knight)] =
+        AttackTables::knightAttacks[kingSquare];
+    context.checkSquares[static_cast<int>(PieceType::Bishop)] = bishopChecks;
+    context.checkSquares[static_cast<int>(PieceType::Rook)] = rookChecks;
+    context.checkSquares[static_cast<int>(PieceType::Queen)] = bishopChecks | rookChecks;
+    context.checkSquares[static_cast<int>(PieceType::King)] = BitBoard();
+
+    // Our pieces alone on a line between one of our sliders and their king
+    context.discoverers = _board.blockersForKing(Them) & context.own;
+}
+
+/**
+ * @brief Narrows the quiet targets of a piece on from down to the ones that give check
+ */
+static BitBoard quietCheckTargets(int from, PieceType type, BitBoard targets, int enemyKingSquare,
+                                  const BitBoard (&checkSquares)[6], BitBoard discoverers) {
+    if (enemyKingSquare < 0) return BitBoard();
+    if (discoverers & squareBB[from]) {
+        // Leaving the line uncovers the check, staying on it may still check directly
+        return targets & (~AttackTables::lineMasks[enemyKingSquare][from] |
+                          checkSquares[static_cast<int>(type)]);
+    }
+    return targets & checkSquares[static_cast<int>(type)];
+}
+
+template <Side::Value Us, GenType Type>
+void MoveGenerator::generateLegalPawnMoves(const LegalContext& context, MoveList& moves) const {
+    constexpr bool wantQuiets = Type != GenType::Captures;
+    constexpr bool wantCaptures = Type != GenType::Quiets && Type != GenType::QuietChecks;
+    // Promotions count as captures: they change the material balance like one
+    constexpr bool wantPromotions = wantCaptures;
+
+    constexpr auto Them = Side::opposite(Us);
+    constexpr auto forward = (Us == Side::White) ? 8 : -8;
+    constexpr auto startRank = (Us == Side::White) ? 1 : 6;
+    constexpr auto promotionRank = (Us == Side::White) ? 7 : 0;
+    const auto& pawnAttacks = AttackTables::pawnAttacks<Us>();
+
+    const auto addPromotions = [&](int from, int to) {
+        moves.emplace_back(from, to, MoveFlag::PromoteToQueenFlag);
+        moves.emplace_back(from, to, MoveFlag::PromoteToRookFlag);
+        moves.emplace_back(from, to, MoveFlag::PromoteToKnightFlag);
+        moves.emplace_back(from, to, MoveFlag::PromoteToBishopFlag);
+    };
+
+    auto pawns = _board.currentState.piecesBitBoards[Us * 6 + static_cast<int>(PieceType::Pawn)];
+    while (pawns) {
+        const auto from = pawns.popLSB().getIndex();
+        const auto promotes = (from + forward) / 8 == promotionRank;
+
+        // A pinned pawn may only move along the line through its king
+        auto allowed = context.checkMask;
+        if (context.pinned & squareBB[from]) {
+            allowed &= AttackTables::lineMasks[context.kingSquare][from];
+        }
+
+        // Pushes
+        if (promotes ? wantPromotions : wantQuiets) {
+            auto pushes = BitBoard();
+            const auto singlePush = from + forward;
+            if (!(context.occupancy & squareBB[singlePush])) {
+                pushes |= squareBB[singlePush];
+                const auto doublePush = singlePush + forward;
+                if (from / 8 == startRank && !(context.occupancy & squareBB[doublePush])) {
+                    pushes |= squareBB[doublePush];
+                }
+            }
+            pushes &= allowed;
+            if constexpr (Type == GenType::QuietChecks) {
+                pushes = quietCheckTargets(from, PieceType::Pawn, pushes, context.enemyKingSquare,
+                                           context.checkSquares, context.discoverers);
+            }
+            while (pushes) {
+                const auto to = pushes.popLSB().getIndex();
+                if (promotes) {
+                    addPromotions(from, to);
+                } else if (to == from + 2 * forward) {
+                    moves.emplace_back(from, to, MoveFlag::PawnTwoUpFlag);
+                } else {
+                    moves.emplace_back(from, to);
+                }
+            }
+        }
+
+        if constexpr (!wantCaptures) continue;
+
+        // Captures
+        auto captures = pawnAttacks[from] & context.enemy & allowed;
+        while (captures) {
+            const auto to = captures.popLSB().getIndex();
+            if (promotes) {
+                addPromotions(from, to);
+            } else {
+                moves.emplace_back(from, to);
+            }
+        }
+
+        // En passant removes two pieces from the capturing rank, which can expose the king to a
+        // slider along that rank. Check it by recomputing the attackers on the resulting board.
+        if (_board.enPassantSquare.has_value()) {
+            const auto target = _board.enPassantSquare.value().getIndex();
+            if (!(pawnAttacks[from] & squareBB[target])) continue;
+
+            const auto capturedSquare = target - forward;
+            const auto occupancyAfter =
+                (context.occupancy ^ squareBB[from] ^ squareBB[capturedSquare]) | squareBB[target];
+            if (context.kingSquare < 0 ||
+                (_board.attackersTo<Them>(context.kingSquare, occupancyAfter) &
+                 ~squareBB[capturedSquare])
+                    .isEmpty()) {
+                moves.emplace_back(from, target, MoveFlag::EnPassantCaptureFlag);
+            }
+        }
+    }
+}
 
-    // Generate all pseudo-legal moves first
-    auto pseudoLegalMoves = generatePseudoLegalMoves();
+template <Side::Value Us, GenType Type>
+void MoveGenerator::generateLegalPieceMoves(const LegalContext& context, MoveList& moves) const {
+    const auto& pieces = _board.currentState.piecesBitBoards;
 
-    // Filter out moves that leave king in check
-    _legalMoves.reserve(pseudoLegalMoves.size()); // Pre-allocate
+    BitBoard targets;
+    if constexpr (Type == GenType::Captures) {
+        targets = context.enemy;
+    } else if constexpr (Type == GenType::Quiets || Type == GenType::QuietChecks) {
+        targets = ~context.occupancy;
+    } else {
+        targets = ~context.own;
+    }
+    targets &= context.checkMask;
 
-    for (const auto& move : pseudoLegalMoves) {
-        if (isLegalMove(move)) {
-            _legalMoves.push_back(move);
+    const auto addMoves = [&](int from, PieceType type, BitBoard moveTargets) {
+        if constexpr (Type == GenType::QuietChecks) {
+            moveTargets = quietCheckTargets(from, type, moveTargets, context.enemyKingSquare,
+                                            context.checkSquares, context.discoverers);
+        }
+        while (moveTargets) {
+            moves.emplace_back(from, moveTargets.popLSB().getIndex());
         }
+    };
+
+    // Pinned knights can never move
+    auto knights = pieces[Us * 6 + static_cast<int>(PieceType::Knight)] & ~context.pinned;
+    while (knights) {
+        const auto from = knights.popLSB().getIndex();
+        addMoves(from, PieceType::Knight, AttackTables::knightAttacks[from] & targets);
     }
 
-    return _legalMoves;
+    const auto addSliderMoves = [&](PieceType type, auto attacksFrom) {
+        auto sliders = pieces[Us * 6 + static_cast<int>(type)];
+        while (sliders) {
+            const auto from = sliders.popLSB().getIndex();
+            auto moveTargets = attacksFrom(from) & targets;
+            if (context.pinned & squareBB[from]) {
+                moveTargets &= AttackTables::lineMasks[context.kingSquare][from];
+            }
+            addMoves(from, type, moveTargets);
+        }
+    };
+
+    addSliderMoves(PieceType::Bishop, [&](int from) {
+        return AttackTables::bishopAttacks(from, context.occupancy);
+    });
+    addSliderMoves(PieceType::Rook, [&](int from) {
+        return AttackTables::rookAttacks(from, context.occupancy);
+    });
+    addSliderMoves(PieceType::Queen, [&](int from) {
+        return AttackTables::queenAttacks(from, context.occupancy);
+    });
+}
+
+template <Side::Value Us, GenType Type>
+void MoveGenerator::generateLegalKingMoves(const LegalContext& context, MoveList& moves) const {
+    if (context.kingSquare < 0) return;
+
+    constexpr auto Them = Side::opposite(Us);
+    const auto from = context.kingSquare;
+
+    BitBoard targets = AttackTables::kingAttacks[from];
+    if constexpr (Type == GenType::Captures) {
+        targets &= context.enemy;
+    } else if constexpr (Type == GenType::Quiets) {
+        targets &= ~context.occupancy;
+    } else if constexpr (Type == GenType::QuietChecks) {
+        // The king only ever checks by discovery
+        targets &= ~context.occupancy;
+        targets = quietCheckTargets(from, PieceType::King, targets, context.enemyKingSquare,
+                                    context.checkSquares, context.discoverers);
+    } else {
+        targets &= ~context.own;
+    }
+
+    // The king must not shadow itself: sliders attacking it keep attacking along the ray once it
+    // steps away, so look up attackers with the king removed from the occupancy
+    const auto occupancyWithoutKing = context.occupancy ^ squareBB[from];
+    while (targets) {
+        const auto to = targets.popLSB().getIndex();
+        if (_board.attackersTo<Them>(to, occupancyWithoutKing).isEmpty()) {
+            moves.emplace_back(from, to);
+        }
+    }
+
+    // Castling: never out of check, the squares between king and rook must be empty and the squares
+    // the king crosses must not be attacked
+    if constexpr (Type == GenType::Captures || Type == GenType::Evasions) return;
+    if (context.checkers) return;
+
+    constexpr auto rank = (Us == Side::White) ? 0 : 7;
+    constexpr auto kingsideRight = (Us == Side::White) ? Board::whiteKingside : Board::blackKingside;
+    constexpr auto queensideRight =
+        (Us == Side::White) ? Board::whiteQueenside : Board::blackQueenside;
+    const auto rooks = _board.currentState.piecesBitBoards[Us * 6 + static_cast<int>(PieceType::Rook)];
+    const auto isSafe = [&](int square) {
+        return _board.attackersTo<Them>(square, context.occupancy).isEmpty();
+    };
+    // Castling checks with the rook on its new square or by uncovering a slider behind the king
+    const auto castleChecks = [&](int rookFrom, int rookTo, int kingTo) {
+        if (context.enemyKingSquare < 0) return false;
+        const auto& state = _board.currentState;
+        const auto occupancyAfter = (context.occupancy ^ squareBB[from] ^ squareBB[rookFrom]) |
+                                    squareBB[kingTo] | squareBB[rookTo];
+        const auto orthoAfter = (state.orthoSliders[Us] ^ squareBB[rookFrom]) | squareBB[rookTo];
+        return !(
+            (AttackTables::rookAttacks(context.enemyKingSquare, occupancyAfter) & orthoAfter) |
+            (AttackTables::bishopAttacks(context.enemyKingSquare, occupancyAfter) &
+             state.diagonalSliders[Us]))
+                    .isEmpty();
+    };
+
+    if (from != rank * 8 + 4) return; // Rights without the king on its home square
+
+    if ((_board.castlingRights & kingsideRight) && (rooks & squareBB[rank * 8 + 7]) &&
+        !(context.occupancy & AttackTables::betweenMasks[from][rank * 8 + 7]) &&
+        isSafe(rank * 8 + 5) && isSafe(rank * 8 + 6)) {
+        if (Type != GenType::QuietChecks || castleChecks(rank * 8 + 7, rank * 8 + 5, rank * 8 + 6)) {
+            moves.emplace_back(from, rank * 8 + 6, MoveFlag::CastleFlag);
+        }
+    }
+    if ((_board.castlingRights & queensideRight) && (rooks & squareBB[rank * 8]) &&
+        !(context.occupancy & AttackTables::betweenMasks[from][rank * 8]) &&
+        isSafe(rank * 8 + 3) && isSafe(rank * 8 + 2)) {
+        if (Type != GenType::QuietChecks || castleChecks(rank * 8, rank * 8 + 3, rank * 8 + 2)) {
+            moves.emplace_back(from, rank * 8 + 2, MoveFlag::CastleFlag);
+        }
+    }
 }
 
+template MoveList MoveGenerator::generate<GenType::Captures>();
+template MoveList MoveGenerator::generate<GenType::Quiets>();
+template MoveList MoveGenerator::generate<GenType::QuietChecks>();
+template MoveList MoveGenerator::generate<GenType::Evasions>();
+template MoveList MoveGenerator::generate<GenType::Legal>();
+
 /**
  * @brief Generates Pseudo legal moves for all pieces on the current side
  *
- * @return vector of pseudo legal moves
+ * @return list of pseudo legal moves
  */
-const std::vector<Move> MoveGenerator::generatePseudoLegalMoves() {
+MoveList MoveGenerator::generatePseudoLegalMoves() {
+    MoveList moves;
+    if (_board.side == Side::White) {
+        generatePseudoLegalMovesFor<Side::White>(moves);
+    } else {
+        generatePseudoLegalMovesFor<Side::Black>(moves);
+    }
+    return moves;
+}
 
-    std::vector<Move> moves;
-    auto pieces = _board.currentState.colorBitBoards[_board.side];
+template <Side::Value Us> void MoveGenerator::generatePseudoLegalMovesFor(MoveList& moves) {
+    auto pieces = _board.currentState.colorBitBoards[Us];
     while (pieces) {
         Square from(pieces.popLSB());
         const auto piece = _board.getPieceAt(from);
 
-        _moveBuffer.clear();
-
         switch (piece.type) {
         case PieceType::Pawn:
-            this->generatePawnMoves(from, _moveBuffer);
+            this->generatePawnMovesFor<Us>(from, moves);
             break;
         case PieceType::King:
-            this->generateKingMoves(from, _moveBuffer);
+            this->generateKingMovesFor<Us>(from, moves);
             break;
         case PieceType::Queen:
-            this->generateQueenMoves(from, _moveBuffer);
+            this->generateQueenMoves(from, moves);
             break;
         case PieceType::Knight:
-            this->generateKnightMoves(from, _moveBuffer);
+            this->generateKnightMoves(from, moves);
             break;
         case PieceType::Bishop:
-            this->generateBishopMoves(from, _moveBuffer);
+            this->generateBishopMoves(from, moves);
             break;
         case PieceType::Rook:
-            this->generateRookMoves(from, _moveBuffer);
+            this->generateRookMoves(from, moves);
             break;
         default:
             break;
         }
-
-        moves.insert(moves.end(), std::make_move_iterator(_moveBuffer.begin()),
-                     std::make_move_iterator(_moveBuffer.end()));
     }
-
-    return moves;
 }
 
 /**
- * @brief Makes a move on the board ,checks if the board is in check and undos
+ * @brief Makes a move on the board, checks if it left the moving side's king attacked and undoes
+ * it again. Works on the board in place so no copy of the board (and its undo history) is made.
  *
  * @param move
- * @return true if not in check, false otherwise
+ * @return true if the king of the moving side is safe, false otherwise
  */
-// bool MoveGenerator::isLegalMove(const Move move) const {
-//     const auto undoinfo =
-//         _board.makeMove(Square(move.startSquareIndex()), Square(move.targetSquareIndex()));
-//     const auto legal = !_board.isInCheck();
-//     _board.unMakeMove(Square(move.startSquareIndex()), Square(move.targetSquareIndex()),
-//     undoinfo); return legal;
-// }
-
 bool MoveGenerator::isLegalMove(const Move move) const {
-    auto _tempBoard = _board;
-    _tempBoard.makeMove(Square(move.startSquareIndex()), Square(move.targetSquareIndex()));
-    return !_tempBoard.isInCheck();
+    const auto movingSide = _board.side;
+    _board.makeMove(move);
+    const auto legal = !_board.isSquareAttacked(_board.findKingSquare(movingSide), _board.side);
+    _board.unMakeMove(move);
+    return legal;
 }
 
-void MoveGenerator::generatePawnMoves(Square square, std::vector<Move>& moves) {
+void MoveGenerator::generatePawnMoves(Square square, MoveList& moves) {
+    if (_board.side == Side::White) {
+        generatePawnMovesFor<Side::White>(square, moves);
+    } else {
+        generatePawnMovesFor<Side::Black>(square, moves);
+    }
+}
+
+template <Side::Value Us> void MoveGenerator::generatePawnMovesFor(Square square, MoveList& moves) {
     auto piece = _board.getPieceAt(square);
 
-    if (piece.type != PieceType::Pawn || piece.side != _board.side) {
+    if (piece.type != PieceType::Pawn || piece.side != Us) {
         std::cerr << "Wrong Piece";
         return;
     }
 
-    const auto direction = (_board.side == Side::White) ? 1 : -1;
-    const auto startRank = (_board.side == Side::White) ? 1 : 6;
-    const auto promotionRank = (_board.side == Side::White) ? 7 : 0;
+    constexpr auto direction = (Us == Side::White) ? 1 : -1;
+    constexpr auto startRank = (Us == Side::White) ? 1 : 6;
+    constexpr auto promotionRank = (Us == Side::White) ? 7 : 0;
 
     const auto addPromotionMoves = [&](int fromIndex, int toIndex) {
         moves.emplace_back(fromIndex, toIndex, MoveFlag::PromoteToQueenFlag);
@@ -129,10 +444,8 @@ void MoveGenerator::generatePawnMoves(Square square, std::vector<Move>& moves) {
     }
 
     // Captures
-    const auto attacks = (_board.side == Side::White)
-                             ? AttackTables::whitePawnAttacks[square.getIndex()]
-                             : AttackTables::blackPawnAttacks[square.getIndex()];
-    const auto ownPieces = _board.currentState.colorBitBoards[_board.side];
+    const auto attacks = AttackTables::pawnAttacks<Us>()[square.getIndex()];
+    const auto ownPieces = _board.currentState.colorBitBoards[Us];
 
     const auto occupancy = _board.currentState.colorBitBoards[Side::White] |
                            _board.currentState.colorBitBoards[Side::Black];
@@ -150,7 +463,7 @@ void MoveGenerator::generatePawnMoves(Square square, std::vector<Move>& moves) {
     // En Passant
     if (_board.enPassantSquare.has_value()) {
         const auto enPassantSquare = _board.enPassantSquare.value();
-        const auto capturingPawnRank = (_board.side == Side::White) ? 4 : 3;
+        constexpr auto capturingPawnRank = (Us == Side::White) ? 4 : 3;
         if (square.getRankIndex() == capturingPawnRank &&
             std::abs(enPassantSquare.getFile() - square.getFile()) == 1) {
             moves.emplace_back(square.getIndex(), enPassantSquare.getIndex(),
@@ -159,7 +472,7 @@ void MoveGenerator::generatePawnMoves(Square square, std::vector<Move>& moves) {
     }
 }
 
-void MoveGenerator::generateKnightMoves(Square square, std::vector<Move>& moves) {
+void MoveGenerator::generateKnightMoves(Square square, MoveList& moves) {
     const auto piece = _board.getPieceAt(square);
     if (piece.type != PieceType::Knight || piece.side != _board.side) std::cerr << "Wrong Piece";
 
@@ -172,13 +485,22 @@ void MoveGenerator::generateKnightMoves(Square square, std::vector<Move>& moves)
     }
 }
 
-void MoveGenerator::generateKingMoves(Square square, std::vector<Move>& moves) {
-    const auto piece = _board.getPieceAt(square);
-    assert(piece.type == PieceType::King && piece.side == _board.side);
+void MoveGenerator::generateKingMoves(Square square, MoveList& moves) {
+    if (_board.side == Side::White) {
+        generateKingMovesFor<Side::White>(square, moves);
+    } else {
+        generateKingMovesFor<Side::Black>(square, moves);
+    }
+}
+
+template <Side::Value Us> void MoveGenerator::generateKingMovesFor(Square square, MoveList& moves) {
+    constexpr auto Them = Side::opposite(Us);
+    [[maybe_unused]] const auto piece = _board.getPieceAt(square);
+    assert(piece.type == PieceType::King && piece.side == Us);
 
     // Normal moves
     const auto attacks = AttackTables::kingAttacks[square.getIndex()];
-    const auto ownPieces = _board.currentState.colorBitBoards[_board.side];
+    const auto ownPieces = _board.currentState.colorBitBoards[Us];
     auto validTargets = attacks & ~ownPieces;
 
     while (validTargets) {
@@ -187,81 +509,62 @@ void MoveGenerator::generateKingMoves(Square square, std::vector<Move>& moves) {
     }
 
     // Castling
-    int rank = (_board.side == Side::White) ? 0 : 7;
-    if (_board.side == Side::White) {
-        if (_board.castlingRights & Board::whiteKingside) {
-            Square f1(5, rank), g1(6, rank);
-            if (_board.getPieceAt(f1).type == PieceType::None &&
-                _board.getPieceAt(g1).type == PieceType::None &&
-                !isSquareAttacked(square, !_board.side) && !isSquareAttacked(f1, !_board.side) &&
-                !isSquareAttacked(g1, !_board.side)) {
-                moves.emplace_back(square.getIndex(), g1.getIndex(), MoveFlag::CastleFlag);
-            }
-        }
-        if (_board.castlingRights & Board::whiteQueenside) {
-            Square d1(3, rank), c1(2, rank), b1(1, rank);
-            if (_board.getPieceAt(d1).type == PieceType::None &&
-                _board.getPieceAt(c1).type == PieceType::None &&
-                _board.getPieceAt(b1).type == PieceType::None &&
-                !isSquareAttacked(square, !_board.side) && !isSquareAttacked(d1, !_board.side) &&
-                !isSquareAttacked(c1, !_board.side)) {
-                moves.emplace_back(square.getIndex(), c1.getIndex(), MoveFlag::CastleFlag);
-            }
+    constexpr int rank = (Us == Side::White) ? 0 : 7;
+    constexpr auto kingsideRight = (Us == Side::White) ? Board::whiteKingside : Board::blackKingside;
+    constexpr auto queensideRight =
+        (Us == Side::White) ? Board::whiteQueenside : Board::blackQueenside;
+    if (_board.castlingRights & kingsideRight) {
+        Square f(5, rank), g(6, rank);
+        if (_board.getPieceAt(f).type == PieceType::None &&
+            _board.getPieceAt(g).type == PieceType::None &&
+            !_board.isSquareAttacked<Them>(square) && !_board.isSquareAttacked<Them>(f) &&
+            !_board.isSquareAttacked<Them>(g)) {
+            moves.emplace_back(square.getIndex(), g.getIndex(), MoveFlag::CastleFlag);
         }
-    } else {
-        if (_board.castlingRights & Board::blackKingside) {
-            Square f8(5, rank), g8(6, rank);
-            if (_board.getPieceAt(f8).type == PieceType::None &&
-                _board.getPieceAt(g8).type == PieceType::None &&
-                !isSquareAttacked(square, !_board.side) && !isSquareAttacked(f8, !_board.side) &&
-                !isSquareAttacked(g8, !_board.side)) {
-                moves.emplace_back(square.getIndex(), g8.getIndex(), MoveFlag::CastleFlag);
-            }
-        }
-        if (_board.castlingRights & Board::blackQueenside) {
-            Square d8(3, rank), c8(2, rank), b8(1, rank);
-            if (_board.getPieceAt(d8).type == PieceType::None &&
-                _board.getPieceAt(c8).type == PieceType::None &&
-                _board.getPieceAt(b8).type == PieceType::None &&
-                !isSquareAttacked(square, !_board.side) && !isSquareAttacked(d8, !_board.side) &&
-                !isSquareAttacked(c8, !_board.side)) {
-                moves.emplace_back(square.getIndex(), c8.getIndex(), MoveFlag::CastleFlag);
-            }
+    }
+    if (_board.castlingRights & queensideRight) {
+        Square d(3, rank), c(2, rank), b(1, rank);
+        if (_board.getPieceAt(d).type == PieceType::None &&
+            _board.getPieceAt(c).type == PieceType::None &&
+            _board.getPieceAt(b).type == PieceType::None &&
+            !_board.isSquareAttacked<Them>(square) && !_board.isSquareAttacked<Them>(d) &&
+            !_board.isSquareAttacked<Them>(c)) {
+            moves.emplace_back(square.getIndex(), c.getIndex(), MoveFlag::CastleFlag);
         }
     }
 }
-void MoveGenerator::generateBishopMoves(Square square, std::vector<Move>& moves) {
-    generateSlidingMoves(square, AttackTables::bishopOffsets, 4, moves);
+
+void MoveGenerator::generateBishopMoves(Square square, MoveList& moves) {
+    const auto occupancy = _board.currentState.colorBitBoards[Side::White] |
+                           _board.currentState.colorBitBoards[Side::Black];
+    generateSlidingMoves(square, AttackTables::bishopAttacks(square.getIndex(), occupancy), moves);
 }
 
-void MoveGenerator::generateRookMoves(Square square, std::vector<Move>& moves) {
-    return generateSlidingMoves(square, AttackTables::rookOffsets, 4, moves);
+void MoveGenerator::generateRookMoves(Square square, MoveList& moves) {
+    const auto occupancy = _board.currentState.colorBitBoards[Side::White] |
+                           _board.currentState.colorBitBoards[Side::Black];
+    generateSlidingMoves(square, AttackTables::rookAttacks(square.getIndex(), occupancy), moves);
 }
 
-void MoveGenerator::generateQueenMoves(Square square, std::vector<Move>& moves) {
-    return generateSlidingMoves(square, AttackTables::queenOffsets, 8, moves);
+void MoveGenerator::generateQueenMoves(Square square, MoveList& moves) {
+    const auto occupancy = _board.currentState.colorBitBoards[Side::White] |
+                           _board.currentState.colorBitBoards[Side::Black];
+    generateSlidingMoves(square, AttackTables::queenAttacks(square.getIndex(), occupancy), moves);
 }
 
-void MoveGenerator::generateSlidingMoves(Square square, const Offset* directions, int numDirections,
-                                         std::vector<Move>& moves) const {
+/**
+ * @brief Emits a move to every square of the slider attack set that is not occupied by our own
+ * pieces
+ *
+ * @param square Square of the sliding piece
+ * @param attacks Attack set looked up from the magic tables for the current occupancy
+ */
+void MoveGenerator::generateSlidingMoves(Square square, BitBoard attacks,
+                                         MoveList& moves) const {
     const auto piece = _board.getPieceAt(square);
     if (piece.type == PieceType::None || piece.side != _board.side) std::cerr << "Wrong Piece";
 
-    const auto occupancy = _board.currentState.colorBitBoards[Side::White] |
-                           _board.currentState.colorBitBoards[Side::Black];
-
     const auto ownPieces = _board.currentState.colorBitBoards[_board.side];
-    BitBoard attacks;
-
-    for (auto i = 0; i < numDirections; ++i) {
-        auto current = square;
-        while (true) {
-            current = current.tryOffset(directions[i]);
-            if (current == Square::None) break;
-            attacks.set(current);
-            if (occupancy.contains(current)) break;
-        }
-    }
 
     auto validTargets = attacks & ~ownPieces;
     while (validTargets) {
@@ -270,94 +573,17 @@ void MoveGenerator::generateSlidingMoves(Square square, const Offset* directions
     }
 }
 
-bool MoveGenerator::isSquareAttacked(Square square, Side attackerSide) const {
-    const auto attackerPieces = _board.currentState.colorBitBoards[attackerSide];
-    if (attackerPieces.isEmpty()) return false; // Quick exit if no attacker pieces
-
-    // Check pawn attacks using precomputed tables
-    const auto pawnAttacks = (attackerSide == Side::White)
-                                 ? AttackTables::blackPawnAttacks[square.getIndex()]
-                                 : AttackTables::whitePawnAttacks[square.getIndex()];
-    if (pawnAttacks &
-        _board.currentState.piecesBitBoards[attackerSide * 6 + static_cast<int>(PieceType::Pawn)]) {
-        return true;
-    }
-
-    // Check knight attacks using precomputed tables
-    if (AttackTables::knightAttacks[square.getIndex()] &
-        _board.currentState
-            .piecesBitBoards[attackerSide * 6 + static_cast<int>(PieceType::Knight)]) {
-        return true;
-    }
-
-    // Check king attacks using precomputed tables
-    if (AttackTables::kingAttacks[square.getIndex()] &
-        _board.currentState.piecesBitBoards[attackerSide * 6 + static_cast<int>(PieceType::King)]) {
-        return true;
-    }
-
-    // Get occupancy bitboard for blocking pieces
-    const BitBoard occupancy = _board.currentState.colorBitBoards[Side::White] |
-                               _board.currentState.colorBitBoards[Side::Black];
-
-    const int squareIdx = square.getIndex();
-
-    // Check diagonal attacks (bishops and queens)
-    const auto bishopQueens =
-        _board.currentState
-            .piecesBitBoards[attackerSide * 6 + static_cast<int>(PieceType::Bishop)] |
-        _board.currentState.piecesBitBoards[attackerSide * 6 + static_cast<int>(PieceType::Queen)];
-    if (!bishopQueens.isEmpty()) {
-        // Check each diagonal direction using precomputed ray masks
-        for (int dir = 0; dir < 4; ++dir) { // 0-3 are diagonal directions
-            BitBoard ray = AttackTables::rayMasks[squareIdx][dir];
-            BitBoard blockers = ray & occupancy;
-
-            if (!blockers.isEmpty()) {
-                // Find the closest blocker in this direction
-                Square blockerSq;
-                if (dir < 2) { // NW, NE directions
-                    blockerSq = Square(blockers.popLSB());
-                } else { // SW, SE directions
-                    blockerSq = Square(blockers.popMSB());
-                }
-                // Trim the ray at the first blocker
-                ray &= ~AttackTables::rayMasks[blockerSq.getIndex()][dir];
-            }
-
-            if (ray & bishopQueens) return true;
-        }
-    }
-
-    // Check orthogonal attacks (rooks and queens)
-    const auto rookQueens =
-        _board.currentState.piecesBitBoards[attackerSide * 6 + static_cast<int>(PieceType::Rook)] |
-        _board.currentState.piecesBitBoards[attackerSide * 6 + static_cast<int>(PieceType::Queen)];
-    if (!rookQueens.isEmpty()) {
-        // Check each orthogonal direction using precomputed ray masks
-        for (int dir = 4; dir < 8; ++dir) { // 4-7 are orthogonal directions
-            BitBoard ray = AttackTables::rayMasks[squareIdx][dir];
-            BitBoard blockers = ray & occupancy;
-
-            if (!blockers.isEmpty()) {
-                // Find the closest blocker in this direction
-                Square blockerSq;
-                if (dir == 4 || dir == 6) { // North, West directions
-                    blockerSq = Square(blockers.popLSB());
-                } else { // South, East directions
-                    blockerSq = Square(blockers.popMSB());
-                }
-                // Trim the ray at the first blocker
-                ray &= ~AttackTables::rayMasks[blockerSq.getIndex()][dir];
-            }
-
-            if (ray & rookQueens) return true;
-        }
-    }
+bool MoveGenerator::isSquareAttacked(Square square, Side Attacker) const {
+    return _board.isSquareAttacked(square, Attacker);
+}
 
-    return false;
+template <Side::Value Attacker> bool MoveGenerator::isSquareAttacked(Square square) const {
+    return _board.isSquareAttacked<Attacker>(square);
 }
 
+template bool MoveGenerator::isSquareAttacked<Side::White>(Square square) const;
+template bool MoveGenerator::isSquareAttacked<Side::Black>(Square square) const;
+
 BitBoard MoveGenerator::getAttacksForPiece(Piece piece) const {
     // Implementation to be added if needed
     return BitBoard();
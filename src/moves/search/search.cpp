@@ -0,0 +1,584 @@
+#include "moves/search/search.hpp"
+#include "evaluation/evaluation.hpp"
+#include "moves/generation/move_generation.hpp"
+#include <algorithm>
+#include <cctype>
+#include <mutex>
+#include <sstream>
+
+namespace {
+
+// Ordering scores, the hash move (from the table, else the previous principal variation) first,
+// then captures and promotions, then killers, then the other quiet moves
+constexpr int hashMoveScore = 1'000'000;
+constexpr int captureScore = 100'000;
+constexpr int killerScore = 90'000;
+
+// A capture is skipped in quiescence if even winning the piece and this much more for the position
+// would leave the side to move below alpha
+constexpr int deltaMargin = 200;
+
+// Nodes with less depth left are searched on the thread that reaches them: a task copies the
+// position and goes through the pool, so small subtrees would cost more to hand out than to search
+constexpr int minSplitDepth = 4;
+
+bool isCapture(const BoardState& state, const Move move) {
+    return move.isEnPassant() || state.mailbox[move.targetSquareIndex()] != BoardState::noPiece;
+}
+
+// Material a capture or promotion wins outright, before any recapture
+int materialGain(const BoardState& state, const Move move) {
+    const auto& values = Evaluation::materialValues;
+    const auto target = state.mailbox[move.targetSquareIndex()];
+    auto gain = target == BoardState::noPiece ? (move.isEnPassant() ? values[0] : 0)
+                                              : values[target % 6];
+    if (move.isPromotion()) {
+        gain += values[static_cast<int>(move.getPromotionPieceType())] - values[0];
+    }
+    return gain;
+}
+
+} // namespace
+
+// A Lazy SMP helper thread: its own board copy, searched by its own Search that shares the table
+// and stop flag of the main one
+struct Search::Helper {
+    Board board;
+    Search search;
+    std::thread thread;
+
+    Helper(Search& main, std::size_t index) : board(main._board), search(board, main.table) {
+        search.mainSearch = &main;
+        search.threadIndex = index;
+        search.deltaPruning = main.deltaPruning;
+    }
+};
+
+// A node whose younger brothers are searched as tasks. Lives on the owner's stack until the last
+// task is done, tasks of tasks included, so the parent chain is always valid.
+struct Search::SplitPoint {
+    const SplitPoint* parent;
+    const Board& board; // The owner's board at the node, left alone while the owner waits
+    int depth;
+    int ply;
+    int beta;
+    std::atomic<int> alpha; // Written under the mutex, read without it when a task starts
+    std::atomic<bool> cutoff{false};
+    std::atomic<std::size_t> pending;
+    std::atomic<uint64_t> nodes{0};
+    std::atomic<uint64_t> qnodes{0};
+
+    std::mutex mutex;
+    int bestScore;
+    Move bestMove{0}; // Only set if a task raised alpha
+    std::vector<Move> line; // The best move's continuation
+
+    SplitPoint(const SplitPoint* parent, const Board& board, int depth, int ply, int alpha,
+               int beta, int bestScore, std::size_t tasks)
+        : parent(parent), board(board), depth(depth), ply(ply), beta(beta), alpha(alpha),
+          pending(tasks), bestScore(bestScore) {}
+
+    // A brother of this node or of a node above failed high
+    bool cancelled() const {
+        for (auto split = this; split; split = split->parent) {
+            if (split->cutoff.load(std::memory_order_relaxed)) return true;
+        }
+        return false;
+    }
+
+    void update(Move move, int score, const Search& search) {
+        std::lock_guard lock(mutex);
+        if (score <= bestScore) return;
+        bestScore = score;
+        if (score <= alpha.load(std::memory_order_relaxed)) return;
+        alpha.store(score, std::memory_order_relaxed);
+        bestMove = move;
+        line.assign(search.pv[ply + 1].begin() + ply + 1,
+                    search.pv[ply + 1].begin() + search.pvLength[ply + 1]);
+        if (score >= beta) cutoff.store(true, std::memory_order_relaxed);
+    }
+};
+
+// Where a younger brother is searched: a board and a Search with the owner's settings. Each worker
+// keeps the ones it made for the rest of run() and only copies the node's position and killers
+// into one for every task.
+struct Search::SplitTask {
+    Board board;
+    Search search;
+
+    explicit SplitTask(const Search& main)
+        : search(board, main.table, main.threadCount, main.mode) {
+        search.mainSearch = main.mainSearch;
+        search.pool = main.pool;
+        search.limits = main.limits;
+        search.startTime = main.startTime;
+        search.deltaPruning = main.deltaPruning;
+    }
+
+    void reset(const Search& owner, const SplitPoint& split, std::size_t worker) {
+        board.copyRecent(split.board);
+        search.workerIndex = worker;
+        search.splitParent = &split;
+        search.killers = owner.killers;
+        search.stopped = false;
+        search.nodes.store(0, std::memory_order_relaxed);
+        search.qnodes.store(0, std::memory_order_relaxed);
+    }
+};
+
+// The split tasks of one worker. A worker that waits on a split point runs other tasks meanwhile,
+// so it needs one per level of tasks nested like that; they are used as a stack.
+struct Search::SplitWorker {
+    std::vector<std::unique_ptr<SplitTask>> tasks;
+    std::size_t running = 0;
+};
+
+Search::Search(Board& board, TranspositionTable* table, std::size_t threads, ParallelMode mode)
+    : _board(board), table(table), threadCount(std::max<std::size_t>(threads, 1)), mode(mode) {}
+
+Search::~Search() = default;
+
+SearchIteration Search::run(const SearchLimits& searchLimits, const Reporter& report) {
+    limits = searchLimits;
+    startTime = std::chrono::steady_clock::now();
+    stopFlag.store(false, std::memory_order_relaxed);
+    if (table) table->newSearch();
+
+    helpers.clear();
+    SearchIteration result;
+    if (mode == ParallelMode::SplitPoints && threadCount > 1) {
+        // The root is a task too, so the thread searching it helps out while it waits
+        WorkStealingPool threadPool(threadCount);
+        pool = &threadPool;
+        splitWorkers = std::vector<SplitWorker>(threadCount);
+        threadPool.submit([&](std::size_t worker) {
+            workerIndex = worker;
+            result = iterate(1, report);
+        });
+        threadPool.wait();
+        splitWorkers.clear();
+        pool = nullptr;
+    } else {
+        for (std::size_t index = 1; index < threadCount; ++index) {
+            helpers.push_back(std::make_unique<Helper>(*this, index));
+        }
+        for (auto& helper : helpers) {
+            helper->search.limits = limits;
+            helper->search.startTime = startTime;
+            helper->thread = std::thread([&search = helper->search] {
+                search.iterate(1 + static_cast<int>(search.threadIndex % 2), nullptr);
+            });
+        }
+        result = iterate(1, report);
+    }
+
+    stopFlag.store(true, std::memory_order_relaxed);
+    for (auto& helper : helpers) helper->thread.join();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    result.nodes = totalNodes();
+    result.qnodes = totalQuiescenceNodes();
+    result.seconds = elapsed.count();
+    return result;
+}
+
+SearchIteration Search::iterate(int firstDepth, const Reporter& report) {
+    nodes.store(0, std::memory_order_relaxed);
+    qnodes.store(0, std::memory_order_relaxed);
+    completedDepth = 0;
+    stopped = false;
+    previousPv.clear();
+    for (auto& plyKillers : killers) plyKillers.fill(Move(0));
+
+    SearchIteration result{0, 0, 0, 0, 0.0, -1, {}};
+    for (int depth = firstDepth; depth <= std::min(limits.depth, maxPly - 1); ++depth) {
+        const auto score = negamax(depth, 0, -infinity, infinity);
+        if (stopped) break;
+
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+        result = {depth,
+                  score,
+                  totalNodes(),
+                  totalQuiescenceNodes(),
+                  elapsed.count(),
+                  table ? table->hashfull() : -1,
+                  std::vector<Move>(pv[0].begin(), pv[0].begin() + pvLength[0])};
+        previousPv = result.pv;
+        completedDepth = depth;
+        if (report) report(result);
+
+        // No legal move, or a forced mate that this depth already sees to the end
+        if (result.pv.empty() || (isMateScore(score) && mateScore - std::abs(score) <= depth)) {
+            break;
+        }
+    }
+    return result;
+}
+
+int Search::negamax(int depth, int ply, int alpha, int beta) {
+    if (depth <= 0) return quiescence(ply, alpha, beta);
+    pvLength[ply] = ply;
+    if (shouldStop()) return 0;
+    nodes.store(nodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    if (ply > 0 && isDraw()) return 0;
+    if (ply >= maxPly - 1) return evaluate();
+
+    auto hashMove = ply < static_cast<int>(previousPv.size()) ? previousPv[ply] : Move(0);
+    TranspositionTable::Entry entry;
+    if (table && table->probe(_board.zobristKey, entry)) {
+        if (!entry.move.isNull()) hashMove = entry.move;
+
+        // Principal variation nodes are always searched, so the variation stays complete
+        const auto score = scoreFromTable(entry.score, ply);
+        if (beta - alpha == 1 && entry.depth >= depth && boundCutsOff(entry, score, alpha, beta)) {
+            return score;
+        }
+    }
+
+    MoveGenerator generator(_board);
+    auto moves = generator.generateMoves();
+    if (moves.empty()) return _board.isInCheck() ? -mateScore + ply : 0;
+    orderMoves(moves, ply, hashMove);
+
+    const auto originalAlpha = alpha;
+    auto bestScore = -infinity;
+    auto bestMove = Move(0);
+    for (std::size_t i = 0; i < moves.size(); ++i) {
+        // Young brothers wait: only once the first move is searched do the others go to the pool
+        if (i == 1 && pool && depth >= minSplitDepth) {
+            searchSplit(moves, depth, ply, alpha, beta, bestScore, bestMove);
+            if (stopped) return 0;
+            break;
+        }
+
+        const auto move = moves[i];
+        const auto quiet = !move.isPromotion() && !isCapture(_board.currentState, move);
+
+        _board.makeMove(move);
+        int score;
+        if (i == 0) {
+            score = -negamax(depth - 1, ply + 1, -beta, -alpha);
+        } else {
+            // Expect the first move to stay best, so only prove this one is not better
+            score = -negamax(depth - 1, ply + 1, -alpha - 1, -alpha);
+            if (score > alpha && score < beta) {
+                score = -negamax(depth - 1, ply + 1, -beta, -alpha);
+            }
+        }
+        _board.unMakeMove(move);
+        if (stopped) return 0;
+
+        if (score <= bestScore) continue;
+        bestScore = score;
+        if (score <= alpha) continue;
+        alpha = score;
+        bestMove = move;
+
+        pv[ply][ply] = move;
+        std::copy(pv[ply + 1].begin() + ply + 1, pv[ply + 1].begin() + pvLength[ply + 1],
+                  pv[ply].begin() + ply + 1);
+        pvLength[ply] = std::max(pvLength[ply + 1], ply + 1);
+
+        if (alpha >= beta) {
+            if (quiet && killers[ply][0].value() != move.value()) {
+                killers[ply][1] = killers[ply][0];
+                killers[ply][0] = move;
+            }
+            break;
+        }
+    }
+
+    if (table) {
+        const auto bound = bestScore >= beta            ? TranspositionTable::Bound::Lower
+                           : bestScore > originalAlpha ? TranspositionTable::Bound::Exact
+                                                        : TranspositionTable::Bound::Upper;
+        table->store(_board.zobristKey, bestMove, scoreToTable(bestScore, ply),
+                     TranspositionTable::noEval, depth, bound);
+    }
+    return bestScore;
+}
+
+int Search::quiescence(int ply, int alpha, int beta) {
+    pvLength[ply] = ply;
+    if (shouldStop()) return 0;
+    nodes.store(nodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    qnodes.store(qnodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    if (isDraw()) return 0;
+    if (ply >= maxPly - 1) return evaluate();
+
+    // Quiescence results go into the table at depth 0, with the static evaluation
+    auto hashMove = Move(0);
+    auto eval = TranspositionTable::noEval;
+    TranspositionTable::Entry entry;
+    if (table && table->probe(_board.zobristKey, entry)) {
+        hashMove = entry.move;
+        eval = entry.eval;
+        const auto score = scoreFromTable(entry.score, ply);
+        if (beta - alpha == 1 && boundCutsOff(entry, score, alpha, beta)) return score;
+    }
+
+    const auto inCheck = _board.isInCheck();
+    const auto originalAlpha = alpha;
+    auto bestScore = -infinity;
+    if (!inCheck) {
+        if (eval == TranspositionTable::noEval) eval = evaluate();
+        // Stand pat: the side to move does not have to capture anything
+        if (eval >= beta) {
+            if (table) {
+                table->store(_board.zobristKey, Move(0), scoreToTable(eval, ply), eval, 0,
+                             TranspositionTable::Bound::Lower);
+            }
+            return eval;
+        }
+        bestScore = eval;
+        alpha = std::max(alpha, eval);
+    }
+
+    MoveGenerator generator(_board);
+    auto moves = inCheck ? generator.generate<GenType::Evasions>()
+                         : generator.generate<GenType::Captures>();
+    if (inCheck && moves.empty()) return -mateScore + ply;
+    orderMoves(moves, ply, hashMove);
+
+    auto bestMove = Move(0);
+    for (const auto move : moves) {
+        if (!inCheck) {
+            // A knight, rook or bishop promotion only matters when the queen would stalemate
+            if (move.isPromotion() && move.getPromotionPieceType() != PieceType::Queen) continue;
+            // Delta pruning: hopeless even if the piece comes for free
+            if (deltaPruning &&
+                eval + materialGain(_board.currentState, move) + deltaMargin <= alpha) {
+                continue;
+            }
+            if (!_board.seeGE(move)) continue;
+        }
+
+        _board.makeMove(move);
+        const auto score = -quiescence(ply + 1, -beta, -alpha);
+        _board.unMakeMove(move);
+        if (stopped) return 0;
+
+        if (score <= bestScore) continue;
+        bestScore = score;
+        if (score <= alpha) continue;
+        alpha = score;
+        bestMove = move;
+
+        pv[ply][ply] = move;
+        std::copy(pv[ply + 1].begin() + ply + 1, pv[ply + 1].begin() + pvLength[ply + 1],
+                  pv[ply].begin() + ply + 1);
+        pvLength[ply] = std::max(pvLength[ply + 1], ply + 1);
+        if (alpha >= beta) break;
+    }
+
+    if (table) {
+        const auto bound = bestScore >= beta            ? TranspositionTable::Bound::Lower
+                           : bestScore > originalAlpha ? TranspositionTable::Bound::Exact
+                                                        : TranspositionTable::Bound::Upper;
+        table->store(_board.zobristKey, bestMove, scoreToTable(bestScore, ply),
+                     inCheck ? TranspositionTable::noEval : eval, 0, bound);
+    }
+    return bestScore;
+}
+
+int Search::evaluate() const {
+    const auto score = Evaluation::evaluate(_board);
+    return _board.side == Side::White ? score : -score;
+}
+
+void Search::searchSplit(const MoveList& moves, int depth, int ply, int& alpha, int beta,
+                         int& bestScore, Move& bestMove) {
+    SplitPoint split(splitParent, _board, depth, ply, alpha, beta, bestScore, moves.size() - 1);
+    // Last first: the owner pops its own tasks from the back, so it goes through them best first
+    // while other threads steal the least promising from the front
+    for (auto i = moves.size() - 1; i >= 1; --i) {
+        pool->submit(
+            [this, &split, move = moves[i]](std::size_t worker) {
+                searchSplitMove(split, move, worker);
+            },
+            workerIndex);
+    }
+    while (split.pending.load(std::memory_order_acquire) > 0) {
+        if (!pool->runPendingTask(workerIndex)) std::this_thread::yield();
+    }
+
+    nodes.store(nodes.load(std::memory_order_relaxed) + split.nodes.load(std::memory_order_relaxed),
+                std::memory_order_relaxed);
+    qnodes.store(qnodes.load(std::memory_order_relaxed) +
+                     split.qnodes.load(std::memory_order_relaxed),
+                 std::memory_order_relaxed);
+    // A task that was stopped left a score that means nothing; this node is then stopped too
+    if (shouldStop()) return;
+
+    bestScore = split.bestScore;
+    if (split.bestMove.isNull()) return;
+    alpha = split.alpha.load(std::memory_order_relaxed);
+    bestMove = split.bestMove;
+    pv[ply][ply] = bestMove;
+    std::ranges::copy(split.line, pv[ply].begin() + ply + 1);
+    pvLength[ply] = ply + 1 + static_cast<int>(split.line.size());
+}
+
+void Search::searchSplitMove(SplitPoint& split, Move move, std::size_t worker) {
+    if (!split.cancelled()) {
+        // Only this worker touches its entry
+        auto& splitWorker = mainSearch->splitWorkers[worker];
+        if (splitWorker.running == splitWorker.tasks.size()) {
+            splitWorker.tasks.push_back(std::make_unique<SplitTask>(*mainSearch));
+        }
+        auto& task = *splitWorker.tasks[splitWorker.running++];
+        task.reset(*this, split, worker);
+        auto& search = task.search;
+        const auto ply = split.ply;
+        const auto alpha = split.alpha.load(std::memory_order_relaxed);
+
+        task.board.makeMove(move);
+        auto score = -search.negamax(split.depth - 1, ply + 1, -alpha - 1, -alpha);
+        if (!search.stopped && score > alpha && score < split.beta) {
+            score = -search.negamax(split.depth - 1, ply + 1, -split.beta, -alpha);
+        }
+        split.nodes.fetch_add(search.nodes.load(std::memory_order_relaxed),
+                              std::memory_order_relaxed);
+        split.qnodes.fetch_add(search.qnodes.load(std::memory_order_relaxed),
+                               std::memory_order_relaxed);
+        if (!search.stopped) split.update(move, score, search);
+        --splitWorker.running;
+    }
+    split.pending.fetch_sub(1, std::memory_order_release);
+}
+
+int Search::scoreToTable(int score, int ply) {
+    if (!isMateScore(score)) return score;
+    return score > 0 ? score + ply : score - ply;
+}
+
+int Search::scoreFromTable(int score, int ply) {
+    if (!isMateScore(score)) return score;
+    return score > 0 ? score - ply : score + ply;
+}
+
+bool Search::boundCutsOff(const TranspositionTable::Entry& entry, int score, int alpha, int beta) {
+    return entry.bound == TranspositionTable::Bound::Exact ||
+           (entry.bound == TranspositionTable::Bound::Lower && score >= beta) ||
+           (entry.bound == TranspositionTable::Bound::Upper && score <= alpha);
+}
+
+bool Search::shouldStop() {
+    if (stopped) return true;
+    if (splitParent && splitParent->cancelled()) return stopped = true;
+    // The main thread's first iteration always finishes, so there is a move to return
+    if (mainSearch->completedDepth.load(std::memory_order_relaxed) == 0) return false;
+    if (mainSearch->stopFlag.load(std::memory_order_relaxed)) return stopped = true;
+    // Lazy SMP helpers leave the limits to the main thread
+    if (threadIndex != 0) return false;
+
+    const auto searched = nodes.load(std::memory_order_relaxed);
+    if (limits.nodes && mainSearch == this) {
+        // Summing up every thread's count is only worth it once in a while
+        if (helpers.empty() ? searched >= limits.nodes
+                            : (searched & 1023) == 0 && totalNodes() >= limits.nodes) {
+            stopped = true;
+        }
+    }
+    if (limits.time.count() && (searched & 1023) == 0 &&
+        std::chrono::steady_clock::now() - startTime >= limits.time) {
+        stopped = true;
+    }
+    // Split point tasks on other threads stop as well
+    if (stopped) mainSearch->stop();
+    return stopped;
+}
+
+uint64_t Search::totalNodes() const {
+    auto total = nodes.load(std::memory_order_relaxed);
+    for (const auto& helper : helpers) {
+        total += helper->search.nodes.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t Search::totalQuiescenceNodes() const {
+    auto total = qnodes.load(std::memory_order_relaxed);
+    for (const auto& helper : helpers) {
+        total += helper->search.qnodes.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+bool Search::isDraw() const {
+    if (_board.halfMoveClock >= 100) return true;
+
+    // Any earlier occurrence of the position counts, the side to move repeats it every other ply.
+    // The undo record of the move played d plies ago holds the key from before it.
+    const auto reversible = std::min<std::size_t>(_board.halfMoveClock, _board.undoCount);
+    for (std::size_t distance = 2; distance <= reversible; distance += 2) {
+        if (_board.undoStack[_board.undoCount - distance].previousKey == _board.zobristKey) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Search::orderMoves(MoveList& moves, int ply, Move hashMove) const {
+    const auto& state = _board.currentState;
+    std::array<int, MoveList::capacity> scores;
+    for (std::size_t i = 0; i < moves.size(); ++i) {
+        const auto move = moves[i];
+        const auto attacker = state.mailbox[move.startSquareIndex()] % 6;
+        if (move.value() == hashMove.value()) {
+            scores[i] = hashMoveScore;
+        } else if (isCapture(state, move) || move.isPromotion()) {
+            const auto target = state.mailbox[move.targetSquareIndex()];
+            const auto victim = target == BoardState::noPiece ? static_cast<int>(PieceType::Pawn)
+                                                              : target % 6;
+            const auto promotion = move.isPromotion()
+                                       ? static_cast<int>(move.getPromotionPieceType())
+                                       : 0;
+            scores[i] = captureScore + 100 * (victim + promotion) - attacker;
+        } else if (move.value() == killers[ply][0].value()) {
+            scores[i] = killerScore + 1;
+        } else if (move.value() == killers[ply][1].value()) {
+            scores[i] = killerScore;
+        } else {
+            scores[i] = 0;
+        }
+    }
+
+    // Insertion sort, best first: move lists are short and often nearly sorted already
+    for (std::size_t i = 1; i < moves.size(); ++i) {
+        const auto move = moves[i];
+        const auto score = scores[i];
+        auto j = i;
+        for (; j > 0 && scores[j - 1] < score; --j) {
+            moves[j] = moves[j - 1];
+            scores[j] = scores[j - 1];
+        }
+        moves[j] = move;
+        scores[j] = score;
+    }
+}
+
+std::string Search::formatIteration(const SearchIteration& iteration) {
+    std::ostringstream line;
+    line << "info depth " << iteration.depth << " score ";
+    if (isMateScore(iteration.score)) {
+        // Moves, not plies, negative when the side to move gets mated
+        const auto plies = mateScore - std::abs(iteration.score);
+        line << "mate " << (iteration.score > 0 ? (plies + 1) / 2 : -(plies / 2));
+    } else {
+        line << "cp " << iteration.score;
+    }
+    line << " nodes " << iteration.nodes << " nps " << iteration.nodesPerSecond();
+    if (iteration.hashfull >= 0) line << " hashfull " << iteration.hashfull;
+    line << " time " << static_cast<uint64_t>(iteration.seconds * 1000) << " pv";
+    for (const auto& move : iteration.pv) line << " " << uciMove(move);
+    return line.str();
+}
+
+std::string Search::uciMove(const Move move) {
+    // Move spells squares in upper case, UCI in lower case
+    auto text = std::string(move);
+    std::ranges::transform(text, text.begin(), [](unsigned char c) { return std::tolower(c); });
+    return text;
+}
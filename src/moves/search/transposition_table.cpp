@@ -0,0 +1,94 @@
+#include "moves/search/transposition_table.hpp"
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+TranspositionTable::TranspositionTable(std::size_t megabytes) { resize(megabytes); }
+
+void TranspositionTable::resize(std::size_t megabytes) {
+    const auto bytes = std::max<std::size_t>(megabytes, 1) * 1024 * 1024;
+    bucketCount = std::bit_floor(bytes / sizeof(Bucket));
+    buckets = std::make_unique<Bucket[]>(bucketCount);
+    age = 0;
+}
+
+void TranspositionTable::clear() {
+    for (std::size_t i = 0; i < bucketCount; ++i) {
+        for (auto& slot : buckets[i].slots) {
+            slot.check.store(0, std::memory_order_relaxed);
+            slot.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    age = 0;
+}
+
+uint64_t TranspositionTable::pack(Move move, int score, int eval, int depth, Bound bound,
+                                  uint8_t age) {
+    const auto depthByte = std::clamp(depth, -128, 127);
+    return static_cast<uint64_t>(move.value()) |
+           static_cast<uint64_t>(static_cast<uint16_t>(score)) << 16 |
+           static_cast<uint64_t>(static_cast<uint16_t>(eval)) << 32 |
+           static_cast<uint64_t>(static_cast<uint8_t>(depthByte)) << 48 |
+           static_cast<uint64_t>(bound) << 56 | static_cast<uint64_t>(age) << 58;
+}
+
+TranspositionTable::Entry TranspositionTable::unpack(uint64_t data) {
+    return {Move(static_cast<uint16_t>(data)), static_cast<int16_t>(data >> 16),
+            static_cast<int16_t>(data >> 32), depthOf(data), boundOf(data)};
+}
+
+bool TranspositionTable::probe(uint64_t key, Entry& entry) const {
+    for (const auto& slot : bucketFor(key).slots) {
+        const auto data = slot.data.load(std::memory_order_relaxed);
+        if ((slot.check.load(std::memory_order_relaxed) ^ data) != key) continue;
+        if (boundOf(data) == Bound::None) continue;
+
+        entry = unpack(data);
+        return true;
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, Move move, int score, int eval, int depth,
+                               Bound bound) {
+    auto& bucket = bucketFor(key);
+
+    // The slot already holding this position, else the one worth least: shallow and old
+    Slot* target = nullptr;
+    auto lowestWorth = std::numeric_limits<int>::max();
+    for (auto& slot : bucket.slots) {
+        const auto data = slot.data.load(std::memory_order_relaxed);
+        if ((slot.check.load(std::memory_order_relaxed) ^ data) == key &&
+            boundOf(data) != Bound::None) {
+            if (bound != Bound::Exact && depth + 2 < depthOf(data) && ageOf(data) == age) return;
+            if (move.isNull()) move = Move(static_cast<uint16_t>(data));
+            target = &slot;
+            break;
+        }
+
+        const auto searchesAgo = (age - ageOf(data)) & ageMask;
+        const auto worth = boundOf(data) == Bound::None ? std::numeric_limits<int>::min()
+                                                        : depthOf(data) - 8 * searchesAgo;
+        if (worth < lowestWorth) {
+            lowestWorth = worth;
+            target = &slot;
+        }
+    }
+
+    const auto data = pack(move, score, eval, depth, bound, age);
+    target->check.store(key ^ data, std::memory_order_relaxed);
+    target->data.store(data, std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const {
+    // The first thousand slots stand in for the whole table, keys spread evenly over it
+    const auto sampledBuckets = std::min<std::size_t>(bucketCount, 1000 / slotsPerBucket);
+    int used = 0;
+    for (std::size_t i = 0; i < sampledBuckets; ++i) {
+        for (const auto& slot : buckets[i].slots) {
+            const auto data = slot.data.load(std::memory_order_relaxed);
+            if (boundOf(data) != Bound::None && ageOf(data) == age) ++used;
+        }
+    }
+    return static_cast<int>(used * 1000 / (sampledBuckets * slotsPerBucket));
+}
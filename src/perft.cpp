@@ -1,39 +1,161 @@
 #include "board/board.hpp"
+#include "board/perft_suite.hpp"
+#include "board/perft_table.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program
+              << " <depth> [fen] [--full | --copy-make] [--hash <MB>] [--threads <N>]\n";
+    std::cerr << "       " << program
+              << " --suite <file.epd> [--max-depth <N>] [--threads <N>] [--full]"
+                 " [--format json|csv] [--output <file>]\n";
+    std::cerr << "Example: " << program << " 5\n";
+    std::cerr << "Example: " << program
+              << " 3 \"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/5N2/PPPPQPPP/RNB1KB1R w KQkq - 0 1\"\n";
+    std::cerr << "Example: " << program << " 5 --full\n";
+    std::cerr << "Example: " << program << " 5 --copy-make\n";
+    std::cerr << "Example: " << program << " 7 --hash 256 --threads 8\n";
+    std::cerr << "Example: " << program << " --suite bench/perftsuite.epd --max-depth 5 --format csv\n";
+}
+
+/**
+ * @brief Runs every position of an EPD file, prints one status line per position to stderr and
+ * the machine readable results to stdout (or --output)
+ *
+ * @return Process exit code, non zero if any count differs from the file
+ */
+int runSuite(const std::string& path, int maxDepth, std::size_t threads, Board::PerftMode mode,
+             const std::string& format, const std::string& outputPath) {
+    std::ifstream input(path);
+    if (!input) {
+        std::cerr << "Error: Cannot open EPD file " << path << "\n";
+        return 1;
+    }
+    const auto entries = PerftSuite::parse(input);
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto results = PerftSuite::run(entries, maxDepth, threads, mode);
+    const std::chrono::duration<double> wallTime = std::chrono::steady_clock::now() - start;
+
+    std::size_t failed = 0;
+    for (const auto& result : results) {
+        if (!result.passed()) ++failed;
+        std::cerr << (result.passed() ? "ok   " : "FAIL ") << result.fen << "\n";
+        if (!result.error.empty()) std::cerr << "     " << result.error << "\n";
+        for (const auto& depth : result.depths) {
+            if (depth.passed()) continue;
+            std::cerr << "     depth " << depth.depth << ": expected " << depth.expected
+                      << ", got " << depth.nodes << "\n";
+        }
+    }
+    std::cerr << results.size() - failed << "/" << results.size() << " positions passed\n";
+
+    std::ofstream outputFile;
+    if (!outputPath.empty()) outputFile.open(outputPath);
+    auto& output = outputPath.empty() ? std::cout : outputFile;
+    if (format == "csv") {
+        PerftSuite::writeCsv(output, results);
+    } else {
+        PerftSuite::writeJson(output, results, wallTime.count());
+    }
+
+    return failed == 0 ? 0 : 1;
+}
+
+} // namespace
 
 int main(int argc, char* argv[]) {
+    // --full plays every leaf move (validates makeMove/unMakeMove) instead of bulk counting
+    // --copy-make plays every leaf move too, taking moves back by restoring a Position copy
+    // --hash <MB> caches subtree counts; without it (or with 0) the count is exact. Single
+    // position only, --suite rejects it
+    // --threads <N> splits the tree (or, with --suite, the positions) over N worker threads
+    auto mode = Board::PerftMode::BulkCount;
+    std::size_t hashMegabytes = 0;
+    std::size_t threads = 1;
+    std::string suitePath, format = "json", outputPath;
+    int maxDepth = 0;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const auto hasValue = i + 1 < argc;
+        const auto takesValue = arg == "--hash" || arg == "--threads" || arg == "--suite" ||
+                                arg == "--max-depth" || arg == "--format" || arg == "--output";
+        if (takesValue && !hasValue) {
+            std::cerr << "Error: " << arg << " needs a value\n";
+            printUsage(argv[0]);
+            return 1;
+        }
+        if (arg == "--full") {
+            mode = Board::PerftMode::MakeUnmake;
+        } else if (arg == "--copy-make") {
+            mode = Board::PerftMode::CopyMake;
+        } else if (arg == "--hash" && hasValue) {
+            hashMegabytes = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--threads" && hasValue) {
+            threads = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--suite" && hasValue) {
+            suitePath = argv[++i];
+        } else if (arg == "--max-depth" && hasValue) {
+            maxDepth = std::atoi(argv[++i]);
+        } else if (arg == "--format" && hasValue) {
+            format = argv[++i];
+        } else if (arg == "--output" && hasValue) {
+            outputPath = argv[++i];
+        } else {
+            args.push_back(arg);
+        }
+    }
+
+    if (format != "json" && format != "csv") {
+        std::cerr << "Error: Unknown format " << format << ", expected json or csv\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (!suitePath.empty()) {
+        if (hashMegabytes) {
+            std::cerr << "Error: --hash only applies to a single position, not to --suite\n";
+            printUsage(argv[0]);
+            return 1;
+        }
+        try {
+            return runSuite(suitePath, maxDepth, threads, mode, format, outputPath);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
     // Check for required depth argument
-    if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <depth> [fen]\n";
-        std::cerr << "Example: " << argv[0] << " 5\n";
-        std::cerr
-            << "Example: " << argv[0]
-            << " 3 \"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/5N2/PPPPQPPP/RNB1KB1R w KQkq - 0 1\"\n";
+    if (args.empty()) {
+        printUsage(argv[0]);
         return 1;
     }
 
-    const auto depth = std::atoi(argv[1]);
+    const auto depth = std::atoi(args[0].c_str());
     if (depth <= 0) {
         std::cerr << "Error: Depth must be a positive integer\n";
         return 1;
     }
 
     // Default FEN: Starting position
-    std::string fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
-    std::string initialFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
-    std::string kiwipete = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
-    std::string pos3 = "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1";
-    std::string pos4 = "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1";
-    std::string pos5 = "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8";
-    if (argc > 2) {
-        fen = argv[2];
-    }
+    const auto fen = args.size() > 1 ? args[1] : Board::startPositionFen;
 
     try {
         Board board(fen);
         std::cout << "Running perft test for FEN: " << fen << " at depth " << depth << "\n";
         std::cout << Board::createDiagram(board);
-        board.perft(depth, true); // Run perft with verbose output
+        const auto table = hashMegabytes ? std::make_unique<PerftTable>(hashMegabytes) : nullptr;
+        board.parallelPerft(depth, threads, true, mode, table.get()); // Verbose output
         // board.perftDivide(depth); // Run perftDivide
     } catch (const std::exception& e) {
         std::cerr << "Error: Invalid FEN or board setup: " << e.what() << "\n";
@@ -0,0 +1,104 @@
+#include "threading/work_stealing_pool.hpp"
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(std::size_t threadCount) {
+    threadCount = std::max<std::size_t>(threadCount, 1);
+    for (std::size_t i = 0; i < threadCount; ++i) {
+        queues.push_back(std::make_unique<TaskQueue>());
+    }
+    for (std::size_t i = 0; i < threadCount; ++i) {
+        workers.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard lock(stateMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void WorkStealingPool::submit(Task task) {
+    std::size_t queueIndex;
+    {
+        std::lock_guard lock(stateMutex);
+        queueIndex = nextQueue;
+        nextQueue = (nextQueue + 1) % queues.size();
+    }
+    push(std::move(task), queueIndex);
+}
+
+void WorkStealingPool::submit(Task task, std::size_t workerIndex) {
+    push(std::move(task), workerIndex % queues.size());
+}
+
+void WorkStealingPool::push(Task task, std::size_t queueIndex) {
+    {
+        // Counted before the push so queued never drops below the number of tasks in the deques.
+        // Counting under the state lock means a worker checking for work cannot miss the wake up.
+        std::lock_guard lock(stateMutex);
+        pending.fetch_add(1, std::memory_order_relaxed);
+        queued.fetch_add(1, std::memory_order_release);
+    }
+    {
+        auto& queue = *queues[queueIndex];
+        std::lock_guard lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    workAvailable.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock lock(stateMutex);
+    allDone.wait(lock, [this] { return pending.load(std::memory_order_acquire) == 0; });
+}
+
+bool WorkStealingPool::popLocal(std::size_t workerIndex, Task& task) {
+    auto& queue = *queues[workerIndex];
+    std::lock_guard lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(std::size_t workerIndex, Task& task) {
+    for (std::size_t offset = 1; offset < queues.size(); ++offset) {
+        auto& queue = *queues[(workerIndex + offset) % queues.size()];
+        std::lock_guard lock(queue.mutex);
+        if (queue.tasks.empty()) continue;
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+bool WorkStealingPool::runPendingTask(std::size_t workerIndex) {
+    Task task;
+    if (!popLocal(workerIndex, task) && !steal(workerIndex, task)) return false;
+
+    queued.fetch_sub(1, std::memory_order_acq_rel);
+    task(workerIndex);
+    if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard lock(stateMutex);
+        allDone.notify_all();
+    }
+    return true;
+}
+
+void WorkStealingPool::workerLoop(std::size_t workerIndex) {
+    while (true) {
+        if (runPendingTask(workerIndex)) continue;
+
+        std::unique_lock lock(stateMutex);
+        workAvailable.wait(lock, [this] {
+            return stopping || queued.load(std::memory_order_acquire) > 0;
+        });
+        if (stopping && queued.load(std::memory_order_acquire) == 0) return;
+    }
+}
@@ -1,5 +1,6 @@
 #include "board/board.hpp"
 #include "board/squares.hpp"
+#include "moves/generation/attack_squares.hpp"
 #include <gtest/gtest.h>
 
 TEST(BoardTest, MakeAndUnmakeMove) {
@@ -7,35 +8,78 @@ TEST(BoardTest, MakeAndUnmakeMove) {
 
     Square from("E2");
     Square to("E4");
-    auto undoInfo = board.makeMove(from, to);
+    board.makeMove(from, to);
 
     EXPECT_EQ(board.getPieceAt(from).type, PieceType::None);
     EXPECT_EQ(board.getPieceAt(to).type, PieceType::Pawn);
 
-    board.unMakeMove(from, to, undoInfo);
+    board.unMakeMove(Move(from.getIndex(), to.getIndex()));
 
     EXPECT_EQ(board.getPieceAt(from).type, PieceType::Pawn);
     EXPECT_EQ(board.getPieceAt(to).type, PieceType::None);
 }
 
+TEST(BoardTest, CopyRecentKeepsOnlyTheMovesSinceTheLastPawnMove) {
+    Board board(Board::startPositionFen);
+    board.makeMove(Square("E2"), Square("E4"));
+    board.makeMove(Square("G8"), Square("F6"));
+    board.makeMove(Square("G1"), Square("F3"));
+
+    Board copy;
+    copy.copyRecent(board);
+    EXPECT_EQ(copy.toFEN(), board.toFEN());
+    EXPECT_EQ(copy.zobristKey, board.zobristKey);
+    ASSERT_EQ(copy.undoCount, 2);
+    EXPECT_EQ(copy.lastMove().value(), board.lastMove().value());
+    EXPECT_EQ(copy.undoStack[0].previousKey, board.undoStack[1].previousKey);
+
+    // The copied moves can still be taken back
+    copy.unMakeMove(copy.lastMove());
+    board.unMakeMove(board.lastMove());
+    EXPECT_EQ(copy.zobristKey, board.zobristKey);
+    EXPECT_EQ(copy.toFEN(), board.toFEN());
+}
+
 TEST(BoardTest, InCheck) {
     std::string fen = "rnbqkbnr/ppp1p1pp/3p4/5p1Q/4P3/8/PPPP1PPP/RNB1KBNR b KQkq - 1 3";
     Board board(fen);
     EXPECT_TRUE(board.isInCheck());
 }
 
+TEST(BoardTest, CheckersAndPins) {
+    // Rh1 checks, Bb4 pins the d2 pawn, Re4 pins the e6 knight to the black king
+    Board board("4k3/8/4n3/8/1b2R3/8/3P4/4K2r w - - 0 1");
+    EXPECT_TRUE(board.isInCheck());
+    EXPECT_EQ(board.checkers(), squareBB[Square("H1").getIndex()]);
+    EXPECT_EQ(board.blockersForKing(Side::White), squareBB[Square("D2").getIndex()]);
+    EXPECT_EQ(board.pinners(Side::Black), squareBB[Square("B4").getIndex()]);
+    EXPECT_EQ(board.blockersForKing(Side::Black), squareBB[Square("E6").getIndex()]);
+    EXPECT_EQ(board.pinners(Side::White), squareBB[Square("E4").getIndex()]);
+
+    // Recomputed for the new position after a move, and again after taking it back
+    const auto move = board.flaggedMove(Square("E1"), Square("E2"));
+    board.makeMove(move);
+    EXPECT_FALSE(board.isInCheck());
+    EXPECT_TRUE(board.blockersForKing(Side::White).isEmpty());
+    EXPECT_EQ(board.blockersForKing(Side::Black), squareBB[Square("E6").getIndex()]);
+
+    board.unMakeMove(move);
+    EXPECT_EQ(board.checkers(), squareBB[Square("H1").getIndex()]);
+    EXPECT_EQ(board.blockersForKing(Side::White), squareBB[Square("D2").getIndex()]);
+}
+
 TEST(BoardTest, CastlingKingsideWhite) {
     Board board("r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1");
     Square from("E1");
     Square to("G1");
 
-    auto undoInfo = board.makeMove(from, to);
+    board.makeMove(from, to);
     EXPECT_EQ(board.getPieceAt(Square("G1")).type, PieceType::King);
     EXPECT_EQ(board.getPieceAt(Square("F1")).type, PieceType::Rook);
     EXPECT_EQ(board.getPieceAt(Square("E1")).type, PieceType::None);
     EXPECT_EQ(board.getPieceAt(Square("H1")).type, PieceType::None);
 
-    board.unMakeMove(from, to, undoInfo);
+    board.unMakeMove(Move(from.getIndex(), to.getIndex()));
     EXPECT_EQ(board.getPieceAt("E1").type, PieceType::King);
     EXPECT_EQ(board.getPieceAt("H1").type, PieceType::Rook);
 }
@@ -46,7 +90,7 @@ TEST(BoardTest, CastlingQueensideBlack) {
     Square to("C8");
 
     // std::cout << Board::createDiagram(board);
-    auto undoInfo = board.makeMove(from, to);
+    board.makeMove(from, to);
 
     EXPECT_EQ(board.getPieceAt("C8").type, PieceType::King);
     EXPECT_EQ(board.getPieceAt("D8").type, PieceType::Rook);
@@ -54,7 +98,7 @@ TEST(BoardTest, CastlingQueensideBlack) {
     EXPECT_EQ(board.getPieceAt("A8").type, PieceType::None);
 
     // std::cout << Board::createDiagram(board);
-    board.unMakeMove(from, to, undoInfo);
+    board.unMakeMove(Move(from.getIndex(), to.getIndex()));
     EXPECT_EQ(board.getPieceAt("E8").type, PieceType::King);
     EXPECT_EQ(board.getPieceAt("A8").type, PieceType::Rook);
 }
@@ -64,29 +108,245 @@ TEST(BoardTest, EnPassantCapture) {
 
     Square from("E5");
     Square to("D6");
-    auto undoInfo = board.makeMove(from, to);
+    board.makeMove(from, to);
 
     EXPECT_EQ(board.getPieceAt("D6").type, PieceType::Pawn);
     EXPECT_EQ(board.getPieceAt("D5").type, PieceType::None); // Captured pawn
     EXPECT_EQ(board.getPieceAt("E5").type, PieceType::None);
 
-    board.unMakeMove(from, to, undoInfo);
+    board.unMakeMove(Move(from.getIndex(), to.getIndex()));
     EXPECT_EQ(board.getPieceAt("E5").type, PieceType::Pawn);
     EXPECT_EQ(board.getPieceAt("D5").type, PieceType::Pawn);
     EXPECT_EQ(board.getPieceAt("D6").type, PieceType::None);
 }
 
-// TEST(BoardTest, PawnPromotionToQueen) {
-//     Board board("8/P7/8/8/8/8/8/8 w - - 0 1");
-//     Square from("A7");
-//     Square to("A8");
-//     auto undoInfo = board.makeMove(from, to, PieceType::Queen);
-//
-//     EXPECT_EQ(board.getPieceAt("A8").type, PieceType::Queen);
-//     EXPECT_EQ(board.getPieceAt("A7").type, PieceType::None);
-//
-//     board.unMakeMove(from, to, undoInfo);
-//     EXPECT_EQ(board.getPieceAt("A7").type, PieceType::Pawn);
-//     EXPECT_EQ(board.getPieceAt("A8").type, PieceType::None);
-// }
-//
+TEST(BoardTest, PawnPromotionToQueen) {
+    Board board("8/P7/8/8/8/8/8/8 w - - 0 1");
+    Square from("A7");
+    Square to("A8");
+    board.makeMove(from, to, PieceType::Queen);
+
+    EXPECT_EQ(board.getPieceAt("A8").type, PieceType::Queen);
+    EXPECT_EQ(board.getPieceAt("A7").type, PieceType::None);
+
+    board.unMakeMove(Move(from.getIndex(), to.getIndex(), MoveFlag::PromoteToQueenFlag));
+    EXPECT_EQ(board.getPieceAt("A7").type, PieceType::Pawn);
+    EXPECT_EQ(board.getPieceAt("A8").type, PieceType::None);
+}
+
+TEST(BoardTest, PawnCapturingRookRemovesCastlingRight) {
+    Board board("r3k2r/1P6/8/8/8/8/8/4K3 w kq - 0 1");
+    const Move promotion(Square("B7").getIndex(), Square("A8").getIndex(),
+                         MoveFlag::PromoteToKnightFlag);
+    board.makeMove(promotion.from(), promotion.to(), PieceType::Knight);
+
+    EXPECT_EQ(board.getPieceAt("A8").type, PieceType::Knight);
+    EXPECT_EQ(board.castlingRights, Board::blackKingside);
+
+    board.unMakeMove(promotion);
+    EXPECT_EQ(board.getPieceAt("A8").type, PieceType::Rook);
+    EXPECT_EQ(board.castlingRights, Board::blackKingside | Board::blackQueenside);
+}
+
+TEST(BoardTest, MakeMovePromotesToFlaggedPiece) {
+    Board board("r3k2r/1P6/8/8/8/8/8/4K3 w kq - 0 1");
+    const auto fen = board.toFEN();
+
+    for (const auto& [flag, type] : {std::pair{MoveFlag::PromoteToQueenFlag, PieceType::Queen},
+                                     std::pair{MoveFlag::PromoteToRookFlag, PieceType::Rook},
+                                     std::pair{MoveFlag::PromoteToBishopFlag, PieceType::Bishop},
+                                     std::pair{MoveFlag::PromoteToKnightFlag, PieceType::Knight}}) {
+        const Move move(Square("B7").getIndex(), Square("A8").getIndex(), flag);
+        board.makeMove(move);
+        EXPECT_EQ(board.getPieceAt("A8").type, type);
+        EXPECT_EQ(board.getPieceAt("A8").side, Side::White);
+        EXPECT_EQ(board.castlingRights, Board::blackKingside);
+        EXPECT_EQ(board.zobristKey, board.computeZobristKey());
+
+        board.unMakeMove(move);
+        EXPECT_EQ(board.toFEN(), fen);
+    }
+}
+
+TEST(BoardTest, FlaggedMoveInfersSpecialMoves) {
+    Board board("r3k2r/8/8/3pP3/8/8/1p4P1/R3K2R w KQkq d6 0 1");
+    EXPECT_EQ(board.flaggedMove(Square("E1"), Square("G1")).getMoveFlag(), MoveFlag::CastleFlag);
+    EXPECT_EQ(board.flaggedMove(Square("E1"), Square("C1")).getMoveFlag(), MoveFlag::CastleFlag);
+    EXPECT_EQ(board.flaggedMove(Square("E5"), Square("D6")).getMoveFlag(),
+              MoveFlag::EnPassantCaptureFlag);
+    EXPECT_EQ(board.flaggedMove(Square("G2"), Square("G4")).getMoveFlag(),
+              MoveFlag::PawnTwoUpFlag);
+    EXPECT_EQ(board.flaggedMove(Square("G2"), Square("G3")).getMoveFlag(), MoveFlag::NoFlag);
+    EXPECT_EQ(board.flaggedMove(Square("E1"), Square("F1")).getMoveFlag(), MoveFlag::NoFlag);
+
+    board.side = Side::Black;
+    EXPECT_EQ(board.flaggedMove(Square("B2"), Square("A1"), PieceType::Rook).getMoveFlag(),
+              MoveFlag::PromoteToRookFlag);
+}
+
+TEST(BoardTest, MailboxMatchesFen) {
+    Board board("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    EXPECT_TRUE(board.isConsistent());
+    EXPECT_EQ(board.getPieceAt("E1").type, PieceType::King);
+    EXPECT_EQ(board.getPieceAt("E7").type, PieceType::Queen);
+    EXPECT_EQ(board.getPieceAt("E7").side, Side::Black);
+    EXPECT_EQ(board.getPieceAt("D4").type, PieceType::None);
+}
+
+TEST(BoardTest, MailboxStaysInSyncThroughMakeUnmake) {
+    // Castling, captures and en passant all touch more than the from/to squares
+    Board board("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    const auto fen = board.toFEN();
+
+    MoveGenerator moveGen(board);
+    for (const auto& move : moveGen.generatePseudoLegalMoves()) {
+        board.makeMove(move);
+        EXPECT_TRUE(board.isConsistent()) << static_cast<std::string>(move);
+
+        MoveGenerator replyGen(board);
+        for (const auto& reply : replyGen.generatePseudoLegalMoves()) {
+            board.makeMove(reply);
+            EXPECT_TRUE(board.isConsistent()) << static_cast<std::string>(reply);
+            board.unMakeMove(reply);
+        }
+
+        board.unMakeMove(move);
+        EXPECT_TRUE(board.isConsistent());
+    }
+    EXPECT_EQ(board.toFEN(), fen);
+}
+
+TEST(BoardTest, AttackersToMatchesPieceAttacks) {
+    for (const auto* fen :
+         {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+          "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+          "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"}) {
+        const Board board(fen);
+        const auto occupancy = board.occupancy();
+
+        // Attack set of every piece, looked up from where it stands
+        std::array<BitBoard, 64> attacksFrom{};
+        for (int from = 0; from < 64; ++from) {
+            const auto piece = board.getPieceAt(Square(from));
+            switch (piece.type) {
+            case PieceType::Pawn:
+                attacksFrom[from] = piece.side == Side::White
+                                        ? AttackTables::pawnAttacks<Side::White>()[from]
+                                        : AttackTables::pawnAttacks<Side::Black>()[from];
+                break;
+            case PieceType::Knight:
+                attacksFrom[from] = AttackTables::knightAttacks[from];
+                break;
+            case PieceType::Bishop:
+                attacksFrom[from] = AttackTables::bishopAttacks(from, occupancy);
+                break;
+            case PieceType::Rook:
+                attacksFrom[from] = AttackTables::rookAttacks(from, occupancy);
+                break;
+            case PieceType::Queen:
+                attacksFrom[from] = AttackTables::queenAttacks(from, occupancy);
+                break;
+            case PieceType::King:
+                attacksFrom[from] = AttackTables::kingAttacks[from];
+                break;
+            default:
+                break;
+            }
+        }
+
+        for (int square = 0; square < 64; ++square) {
+            BitBoard expected;
+            for (int from = 0; from < 64; ++from) {
+                if (attacksFrom[from] & squareBB[square]) expected |= squareBB[from];
+            }
+            const auto attackers = board.attackersTo(square, occupancy);
+            EXPECT_EQ(attackers, expected) << fen << " square " << square;
+            EXPECT_EQ(board.attackersTo<Side::White>(square, occupancy),
+                      attackers & board.currentState.colorBitBoards[Side::White]);
+            EXPECT_EQ(board.isSquareAttacked(Square(square), Side::Black),
+                      !(attackers & board.currentState.colorBitBoards[Side::Black]).isEmpty());
+        }
+    }
+}
+
+TEST(BoardTest, SideTemplatedAttackQueriesMatchRuntime) {
+    static_assert(Side::opposite(Side::White) == Side::Black);
+    static_assert(Side::opposite(Side::Black) == Side::White);
+
+    Board board("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    MoveGenerator moveGen(board);
+    for (int index = 0; index < 64; ++index) {
+        const Square square(index);
+        EXPECT_EQ(board.isSquareAttacked<Side::White>(square),
+                  board.isSquareAttacked(square, Side::White));
+        EXPECT_EQ(board.isSquareAttacked<Side::Black>(square),
+                  board.isSquareAttacked(square, Side::Black));
+        EXPECT_EQ(moveGen.isSquareAttacked<Side::White>(square),
+                  board.isSquareAttacked<Side::White>(square));
+        EXPECT_EQ(moveGen.isSquareAttacked<Side::Black>(square),
+                  board.isSquareAttacked<Side::Black>(square));
+    }
+}
+
+TEST(BoardTest, StaticExchangeEvaluation) {
+    struct Case {
+        const char* fen;
+        const char* from;
+        const char* to;
+        PieceType promotion;
+        int expected;
+    };
+    const Case cases[] = {
+        // Undefended pawn
+        {"1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1", "e1", "e5", PieceType::None, 100},
+        // N takes P, N, R, B, Q take back and forth with X-rays on both sides: 100 - 320
+        {"1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1", "d3", "e5", PieceType::None,
+         -220},
+        // The rook behind the capturer wins the recapture back
+        {"3rk3/8/8/3p4/8/8/3R4/3RK3 w - - 0 1", "d2", "d5", PieceType::None, 100},
+        // The knight defending d5 is pinned to its king, unless the bishop is elsewhere
+        {"8/4k3/5n2/3p4/7B/8/8/K2R4 w - - 0 1", "d1", "d5", PieceType::None, 100},
+        {"8/4k3/5n2/3p4/8/7B/8/K2R4 w - - 0 1", "d1", "d5", PieceType::None, -400},
+        // The king cannot take back while the second rook covers d4
+        {"8/8/8/3k4/3p4/8/3R4/3R2K1 w - - 0 1", "d2", "d4", PieceType::None, 100},
+        {"8/8/8/3k4/3p4/8/3R4/6K1 w - - 0 1", "d2", "d4", PieceType::None, -400},
+        // En passant, with and without a recapture
+        {"4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", "e5", "d6", PieceType::None, 100},
+        {"4k3/2p5/8/3pP3/8/8/8/4K3 w - d6 0 1", "e5", "d6", PieceType::None, 0},
+        // Promotions count the promoted piece
+        {"4k3/1P6/8/8/8/8/8/4K3 w - - 0 1", "b7", "b8", PieceType::Queen, 800},
+        {"r3k3/1P6/8/8/8/8/8/4K3 w - - 0 1", "b7", "b8", PieceType::Queen, -100},
+        {"r3k3/1P6/8/8/8/8/8/4K3 w - - 0 1", "b7", "a8", PieceType::Queen, 1300},
+        // Quiet moves, onto an attacked and a safe square
+        {"4k3/8/8/8/2p5/8/8/3RK3 w - - 0 1", "d1", "d3", PieceType::None, -500},
+        {"4k3/8/8/8/2p5/8/8/3RK3 w - - 0 1", "d1", "d2", PieceType::None, 0},
+        // Castling never loses material
+        {"r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1", "e1", "g1", PieceType::None, 0},
+    };
+
+    for (const auto& [fen, from, to, promotion, expected] : cases) {
+        const Board board(fen);
+        const auto move = board.flaggedMove(Square(from), Square(to), promotion);
+        EXPECT_EQ(board.see(move), expected) << fen << " " << from << to;
+        EXPECT_TRUE(board.seeGE(move, expected)) << fen << " " << from << to;
+        EXPECT_FALSE(board.seeGE(move, expected + 1)) << fen << " " << from << to;
+    }
+}
+
+TEST(BoardTest, SeeGEMatchesSee) {
+    for (const auto* fen :
+         {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+          "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+          "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+          "2r3k1/1q3ppp/p3p3/1p1nP3/3P4/P2Q1N2/1P3PPP/2R3K1 b - - 3 24",
+          "rnbqkb1r/pp1p1ppp/4pn2/2pP4/2P5/8/PP2PPPP/RNBQKBNR w KQkq c6 0 4"}) {
+        Board board(fen);
+        for (const auto& move : board.generateLegalMoves()) {
+            const auto value = board.see(move);
+            for (int threshold = -1000; threshold <= 1000; threshold += 10) {
+                EXPECT_EQ(board.seeGE(move, threshold), value >= threshold)
+                    << fen << " " << std::string(move) << " threshold " << threshold;
+            }
+        }
+    }
+}
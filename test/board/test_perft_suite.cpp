@@ -0,0 +1,63 @@
+#include "board/perft_suite.hpp"
+#include <gtest/gtest.h>
+#include <sstream>
+
+TEST(PerftSuiteTest, ParsesEpdLine) {
+    const auto entry = PerftSuite::parseLine(
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - ;D1 20 ;D2 400 ;D3 8902");
+    EXPECT_EQ(entry.fen, "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    ASSERT_EQ(entry.expected.size(), 3);
+    EXPECT_EQ(entry.expected[0], std::make_pair(1, uint64_t{20}));
+    EXPECT_EQ(entry.expected[2], std::make_pair(3, uint64_t{8902}));
+
+    EXPECT_THROW(PerftSuite::parseLine("8/8/8/8/8/8/8/8 w - - ;D1"), std::invalid_argument);
+    EXPECT_THROW(PerftSuite::parseLine("8/8/8 w ;D1 1"), std::invalid_argument);
+}
+
+TEST(PerftSuiteTest, RunsAndReportsEveryDepth) {
+    std::istringstream epd("# comment\n"
+                           "\n"
+                           "4k3/8/8/8/8/8/8/4K2R w K - ;D1 15 ;D2 66 ;D3 1197\n"
+                           "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1 ;D1 14 ;D2 190\n");
+    const auto entries = PerftSuite::parse(epd);
+    ASSERT_EQ(entries.size(), 2);
+
+    const auto results = PerftSuite::run(entries, 0, 2);
+    ASSERT_EQ(results.size(), 2);
+    EXPECT_TRUE(results[0].passed());
+    EXPECT_EQ(results[0].nodes(), 15 + 66 + 1197);
+    // The second line has a deliberately wrong D2 count (191 is correct)
+    EXPECT_FALSE(results[1].passed());
+    EXPECT_EQ(results[1].depths[1].nodes, 191);
+
+    // maxDepth drops the deeper counts
+    EXPECT_EQ(PerftSuite::run(entries, 1, 1)[0].depths.size(), 1);
+
+    std::ostringstream csv;
+    PerftSuite::writeCsv(csv, results);
+    EXPECT_NE(csv.str().find("\"4k3/8/8/8/8/8/8/4K2R w K - 0 1\",3,1197,1197,true"),
+              std::string::npos);
+
+    std::ostringstream json;
+    PerftSuite::writeJson(json, results, 1.0);
+    EXPECT_NE(json.str().find("\"failed\": 1"), std::string::npos);
+}
+
+TEST(PerftSuiteTest, ReportsMalformedPositionAsFailed) {
+    std::istringstream epd("xyz w - - ;D1 20\n"
+                           "4k3/8/8/8/8/8/8/4K2R w K - ;D1 15\n");
+    const auto entries = PerftSuite::parse(epd);
+    ASSERT_EQ(entries.size(), 2);
+
+    const auto results = PerftSuite::run(entries, 0, 2);
+    ASSERT_EQ(results.size(), 2);
+    EXPECT_FALSE(results[0].passed());
+    EXPECT_FALSE(results[0].error.empty());
+    EXPECT_TRUE(results[0].depths.empty());
+    EXPECT_TRUE(results[1].passed());
+
+    std::ostringstream json;
+    PerftSuite::writeJson(json, results, 1.0);
+    EXPECT_NE(json.str().find("\"error\": "), std::string::npos);
+    EXPECT_NE(json.str().find("\"failed\": 1"), std::string::npos);
+}
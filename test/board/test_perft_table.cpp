@@ -0,0 +1,65 @@
+#include "board/board.hpp"
+#include "board/perft_table.hpp"
+#include <gtest/gtest.h>
+
+TEST(PerftTableTest, StoreAndProbe) {
+    PerftTable table(1);
+    PerftTable::Counters counters;
+    uint64_t nodes = 0;
+    EXPECT_FALSE(table.probe(0x1234, 3, nodes, counters));
+
+    table.store(0x1234, 3, 97862);
+    ASSERT_TRUE(table.probe(0x1234, 3, nodes, counters));
+    EXPECT_EQ(nodes, 97862);
+
+    // Same key at another depth is a different subtree
+    EXPECT_FALSE(table.probe(0x1234, 4, nodes, counters));
+    EXPECT_EQ(counters.probes, 3);
+    EXPECT_EQ(counters.hits, 1);
+
+    // The totals only move when the counters are added
+    EXPECT_EQ(table.probes(), 0);
+    table.addCounters(counters);
+    table.addCounters(counters);
+    EXPECT_EQ(table.probes(), 6);
+    EXPECT_EQ(table.hits(), 2);
+
+    table.clear();
+    EXPECT_EQ(table.probes(), 0);
+    EXPECT_FALSE(table.probe(0x1234, 3, nodes, counters));
+}
+
+TEST(PerftTableTest, BucketKeepsDeepestAndMostRecent) {
+    PerftTable table(1);
+    // Keys differing only above the index bits share a bucket
+    const uint64_t first = 0x0100000000000005ULL;
+    const uint64_t second = 0x0200000000000005ULL;
+    const uint64_t third = 0x0300000000000005ULL;
+    PerftTable::Counters counters;
+    uint64_t nodes = 0;
+
+    table.store(first, 5, 500);
+    table.store(second, 2, 20);
+    table.store(third, 3, 30);
+    EXPECT_TRUE(table.probe(first, 5, nodes, counters));
+    EXPECT_EQ(nodes, 500);
+    EXPECT_FALSE(table.probe(second, 2, nodes, counters));
+    EXPECT_TRUE(table.probe(third, 3, nodes, counters));
+    EXPECT_EQ(nodes, 30);
+}
+
+TEST(PerftTableTest, HashedPerftMatchesExactCounts) {
+    PerftTable table(4);
+    Board kiwipete("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    EXPECT_EQ(kiwipete.perft(4, false, Board::PerftMode::BulkCount, &table), 4085603);
+    EXPECT_GT(table.hitRate(), 0.0);
+
+    // Parallel tasks add their counters up as well
+    table.clear();
+    EXPECT_EQ(kiwipete.parallelPerft(4, 3, false, Board::PerftMode::BulkCount, &table), 4085603);
+    EXPECT_GT(table.hits(), 0u);
+
+    table.clear();
+    Board position5("rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8");
+    EXPECT_EQ(position5.perft(4, false, Board::PerftMode::MakeUnmake, &table), 2103487);
+}
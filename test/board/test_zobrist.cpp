@@ -0,0 +1,70 @@
+#include "board/board.hpp"
+#include "board/zobrist.hpp"
+#include <gtest/gtest.h>
+
+// Plays every legal move down to depth and checks the incremental key against a full recompute
+static void checkIncrementalKey(Board& board, int depth) {
+    ASSERT_EQ(board.zobristKey, board.computeZobristKey()) << board.toFEN();
+    if (depth == 0) return;
+
+    const auto keyBefore = board.zobristKey;
+    for (const auto& move : board.generateLegalMoves()) {
+        board.makeMove(move);
+        checkIncrementalKey(board, depth - 1);
+        board.unMakeMove(move);
+        ASSERT_EQ(board.zobristKey, keyBefore) << static_cast<std::string>(move);
+    }
+}
+
+TEST(ZobristTest, IncrementalKeyMatchesRecompute) {
+    for (const auto* fen :
+         {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+          "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+          "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1"}) {
+        Board board(fen);
+        checkIncrementalKey(board, 3);
+    }
+}
+
+TEST(ZobristTest, TranspositionsShareKey) {
+    // 1. Nf3 Nf6 2. Nc3 and 1. Nc3 Nf6 2. Nf3 reach the same position
+    Board first(Board::startPositionFen);
+    first.makeMove(Square("G1"), Square("F3"));
+    first.makeMove(Square("G8"), Square("F6"));
+    first.makeMove(Square("B1"), Square("C3"));
+
+    Board second(Board::startPositionFen);
+    second.makeMove(Square("B1"), Square("C3"));
+    second.makeMove(Square("G8"), Square("F6"));
+    second.makeMove(Square("G1"), Square("F3"));
+
+    EXPECT_EQ(first.zobristKey, second.zobristKey);
+    EXPECT_EQ(first.zobristKey, Board(first.toFEN()).zobristKey);
+}
+
+TEST(ZobristTest, StateTermsChangeKey) {
+    const Board base("r3k2r/8/8/8/4p3/8/3P4/R3K2R w KQkq - 0 1");
+    EXPECT_NE(base.zobristKey, Board("r3k2r/8/8/8/4p3/8/3P4/R3K2R b KQkq - 0 1").zobristKey);
+    EXPECT_NE(base.zobristKey, Board("r3k2r/8/8/8/4p3/8/3P4/R3K2R w Kkq - 0 1").zobristKey);
+    // Clocks are not part of the key
+    EXPECT_EQ(base.zobristKey, Board("r3k2r/8/8/8/4p3/8/3P4/R3K2R w KQkq - 7 30").zobristKey);
+
+    // The double push sets an en passant square, which the same placement reached otherwise lacks
+    Board pushed("r3k2r/8/8/8/4p3/8/3P4/R3K2R w KQkq - 0 1");
+    pushed.makeMove(Square("D2"), Square("D4"));
+    EXPECT_EQ(pushed.zobristKey, Board("r3k2r/8/8/8/3Pp3/8/8/R3K2R b KQkq d3 0 1").zobristKey);
+    EXPECT_NE(pushed.zobristKey, Board("r3k2r/8/8/8/3Pp3/8/8/R3K2R b KQkq - 0 1").zobristKey);
+}
+
+TEST(ZobristTest, NullMoveFlipsSideAndClearsEnPassant) {
+    Board board("r3k2r/8/8/8/3Pp3/8/8/R3K2R b KQkq d3 0 1");
+    const auto key = board.zobristKey;
+
+    board.makeNullMove();
+    EXPECT_EQ(board.zobristKey, Board("r3k2r/8/8/8/3Pp3/8/8/R3K2R w KQkq - 1 2").zobristKey);
+    EXPECT_EQ(board.zobristKey, board.computeZobristKey());
+
+    board.unmakeNullMove();
+    EXPECT_EQ(board.zobristKey, key);
+    EXPECT_EQ(board.enPassantSquare, Square("D3"));
+}
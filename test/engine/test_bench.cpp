@@ -0,0 +1,11 @@
+#include "engine/bench.hpp"
+#include <gtest/gtest.h>
+#include <sstream>
+
+// Update together with the bench positions, or when a change is meant to alter the node count
+TEST(BenchTest, NodeSignature) {
+    std::ostringstream output;
+    const auto result = Bench::run(output);
+    EXPECT_EQ(result.nodes, 16315427);
+    EXPECT_NE(output.str().find("Nodes searched  : 16315427"), std::string::npos);
+}
@@ -0,0 +1,94 @@
+#include "moves/generation/attack_squares.hpp"
+#include <gtest/gtest.h>
+#include <random>
+
+// Sparse random occupancies (three ANDed draws) to get a realistic amount of blockers
+static uint64_t randomOccupancy(std::mt19937_64& rng) { return rng() & rng() & rng(); }
+
+TEST(AttackTablesTest, SliderTableSize) {
+    EXPECT_EQ(AttackTables::sliderTableSize, 5248 + 102400);
+}
+
+TEST(AttackTablesTest, BishopMagicsMatchRayWalk) {
+    std::mt19937_64 rng(42);
+    for (int square = 0; square < 64; ++square) {
+        for (int i = 0; i < 1000; ++i) {
+            const BitBoard occupancy(randomOccupancy(rng));
+            EXPECT_EQ(AttackTables::bishopAttacks(square, occupancy),
+                      AttackTables::computeSlidingAttacks(square, occupancy,
+                                                          AttackTables::bishopOffsets));
+        }
+    }
+}
+
+TEST(AttackTablesTest, RookMagicsMatchRayWalk) {
+    std::mt19937_64 rng(42);
+    for (int square = 0; square < 64; ++square) {
+        for (int i = 0; i < 1000; ++i) {
+            const BitBoard occupancy(randomOccupancy(rng));
+            EXPECT_EQ(AttackTables::rookAttacks(square, occupancy),
+                      AttackTables::computeSlidingAttacks(square, occupancy,
+                                                          AttackTables::rookOffsets));
+        }
+    }
+}
+
+TEST(AttackTablesTest, QueenAttacksOnEmptyBoard) {
+    // Queen on D4 sees 27 squares on an empty board
+    EXPECT_EQ(AttackTables::queenAttacks(Square("D4").getIndex(), BitBoard()).popCount(), 27);
+    // Rook on A1 sees 14 squares, bishop on A1 sees the long diagonal
+    EXPECT_EQ(AttackTables::rookAttacks(0, BitBoard()).popCount(), 14);
+    EXPECT_EQ(AttackTables::bishopAttacks(0, BitBoard()).popCount(), 7);
+}
+
+TEST(AttackTablesTest, BlockersAreIncluded) {
+    // Rook on A1 with blockers on A3 and C1 attacks A2, A3, B1, C1
+    BitBoard occupancy;
+    occupancy.set(Square("A3"));
+    occupancy.set(Square("C1"));
+    BitBoard expected;
+    for (const auto* name : {"A2", "A3", "B1", "C1"}) {
+        expected.set(Square(std::string(name)));
+    }
+    EXPECT_EQ(AttackTables::rookAttacks(0, occupancy), expected);
+}
+
+TEST(AttackTablesTest, SoftwareBitExtractAndDeposit) {
+    const uint64_t mask = 0x0000000000FF0F0FULL;
+    for (uint64_t bits = 0; bits < (1ULL << 16); bits += 97) {
+        EXPECT_EQ(AttackTables::extractBits(AttackTables::depositBits(bits, mask), mask), bits);
+    }
+}
+
+TEST(AttackTablesTest, PextOnlyPreferredWhereItIsNative) {
+    EXPECT_TRUE(AttackTables::pextIsFast("GenuineIntel", 6));
+    EXPECT_FALSE(AttackTables::pextIsFast("AuthenticAMD", 0x15)); // Excavator
+    EXPECT_FALSE(AttackTables::pextIsFast("AuthenticAMD", 0x17)); // Zen 1, Zen 2
+    EXPECT_TRUE(AttackTables::pextIsFast("AuthenticAMD", 0x19));  // Zen 3, Zen 4
+    EXPECT_TRUE(AttackTables::pextIsFast("AuthenticAMD", 0x1A));  // Zen 5
+    EXPECT_FALSE(AttackTables::pextIsFast("HygonGenuine", 0x18));
+
+    if (!AttackTables::cpuSupportsBmi2()) {
+        EXPECT_FALSE(AttackTables::cpuHasFastPext());
+    }
+    EXPECT_EQ(AttackTables::detectSliderBackend(), AttackTables::cpuHasFastPext()
+                                                       ? AttackTables::SliderBackend::Pext
+                                                       : AttackTables::SliderBackend::Magic);
+}
+
+TEST(AttackTablesTest, BackendsAgree) {
+    if (!AttackTables::cpuSupportsBmi2()) GTEST_SKIP() << "CPU has no BMI2";
+
+    const auto previous = AttackTables::sliderBackend;
+    std::mt19937_64 rng(7);
+    for (int square = 0; square < 64; ++square) {
+        for (int i = 0; i < 200; ++i) {
+            const BitBoard occupancy(randomOccupancy(rng));
+            AttackTables::setSliderBackend(AttackTables::SliderBackend::Magic);
+            const auto magicAttacks = AttackTables::queenAttacks(square, occupancy);
+            AttackTables::setSliderBackend(AttackTables::SliderBackend::Pext);
+            EXPECT_EQ(AttackTables::queenAttacks(square, occupancy), magicAttacks);
+        }
+    }
+    AttackTables::setSliderBackend(previous);
+}
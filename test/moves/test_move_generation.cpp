@@ -20,7 +20,7 @@ class MoveGeneratorTest : public testing::Test {
 // Test pawn moves from E2 in the starting position
 TEST_F(MoveGeneratorTest, PawnMovesFromE2) {
     Square e2("e2");
-    std::vector<Move> moves;
+    MoveList moves;
     moveGen.generatePawnMoves(e2, moves);
     std::vector<std::string> moveStrings;
     for (const auto& move : moves) {
@@ -41,7 +41,7 @@ TEST_F(MoveGeneratorTest, PawnMovesFromE2) {
 // Test knight moves from G1 in the starting position
 TEST_F(MoveGeneratorTest, KnightMovesFromG1) {
     Square g1("g1");
-    std::vector<Move> moves;
+    MoveList moves;
     moveGen.generateKnightMoves(g1, moves);
     std::vector<std::string> moveStrings;
     for (const auto& move : moves) {
@@ -61,7 +61,7 @@ TEST_F(MoveGeneratorTest, KnightMovesFromG1) {
 // Test king moves from E1 in the starting position
 TEST_F(MoveGeneratorTest, KingMovesFromE1) {
     Square e1("E1");
-    std::vector<Move> moves;
+    MoveList moves;
     moveGen.generateKingMoves(e1, moves);
     EXPECT_EQ(moves.size(), 0); // No moves in starting position (blocked and no castling yet)
 }
@@ -73,7 +73,7 @@ TEST_F(MoveGeneratorTest, PawnPromotion) {
 
     Square d7("d7");
 
-    std::vector<Move> moves;
+    MoveList moves;
     moveGen.generatePawnMoves(d7, moves);
     std::vector<std::string> moveStrings;
     for (const auto& move : moves) {
@@ -105,7 +105,7 @@ TEST_F(MoveGeneratorTest, EnPassantCaptures) {
         board = Board("rnbqkbnr/p1pppppp/8/3P4/1pP5/8/PP2PPPP/RNBQKBNR b KQkq c3 0 3");
         MoveGenerator moveGen(board);
         Square square("b4");
-        std::vector<Move> moves;
+        MoveList moves;
         moveGen.generatePawnMoves(square, moves);
 
         std::vector<std::string> moveStrings;
@@ -131,7 +131,7 @@ TEST_F(MoveGeneratorTest, EnPassantCaptures) {
         board = Board("rnbqkbnr/p1pppppp/8/3P4/1pP5/8/PP2PPPP/RNBQKBNR b KQkq c3 0 3");
         MoveGenerator moveGen(board);
         Square d4("b4");
-        std::vector<Move> moves;
+        MoveList moves;
         moveGen.generatePawnMoves(d4, moves);
         // std::cout << Board::createDiagram(board);
         std::vector<std::string> moveStrings;
@@ -211,3 +211,192 @@ TEST_F(MoveGeneratorTest, GenerateMoves_KingOnly) {
         EXPECT_EQ(piece.side, Side::White);
     }
 }
+
+TEST_F(MoveGeneratorTest, GenerateMoves_KingInCheck) {
+    // White king on E1 checked by an undefended rook on E2
+    Board board("4k3/8/8/8/8/8/4r3/4K3 w - - 0 1");
+    MoveGenerator moveGen(board);
+
+    const auto moves = moveGen.generateMoves();
+
+    // Kxe2, Kd1 and Kf1; d2 and f2 are covered by the rook
+    EXPECT_EQ(moves.size(), 3);
+    EXPECT_TRUE(moves.contains(Move(Square("E1").getIndex(), Square("E2").getIndex())));
+}
+
+TEST_F(MoveGeneratorTest, GenerateMoves_PinnedPieceStaysOnPinLine) {
+    // The E2 rook is pinned by the E8 rook, the D2 knight by the A5 bishop
+    Board board("4r1k1/8/8/b7/8/8/3NR3/4K3 w - - 0 1");
+    MoveGenerator moveGen(board);
+
+    for (const auto& move : moveGen.generateMoves()) {
+        if (move.from() == Square("D2")) ADD_FAILURE() << "pinned knight moved";
+        if (move.from() == Square("E2")) {
+            EXPECT_EQ(move.to().getFile(), Square("E2").getFile());
+        }
+    }
+}
+
+TEST_F(MoveGeneratorTest, GenerateMoves_EnPassantDiscoveredCheck) {
+    // exd6 would remove both pawns from the fifth rank and expose the king to the H5 rook
+    Board board("8/8/8/K2pP2r/8/8/8/7k w - d6 0 1");
+    MoveGenerator moveGen(board);
+
+    const auto moves = moveGen.generateMoves();
+    EXPECT_FALSE(moves.contains(Move(Square("E5").getIndex(), Square("D6").getIndex(),
+                                     MoveFlag::EnPassantCaptureFlag)));
+}
+
+TEST_F(MoveGeneratorTest, GenerateMoves_MatchesFilteredPseudoLegalMoves) {
+    for (const auto* fen :
+         {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+          "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+          "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"}) {
+        Board board(fen);
+        MoveGenerator moveGen(board);
+
+        const auto legalMoves = moveGen.generateMoves();
+        std::size_t filteredCount = 0;
+        for (const auto& move : moveGen.generatePseudoLegalMoves()) {
+            if (!moveGen.isLegalMove(move)) continue;
+            ++filteredCount;
+            EXPECT_TRUE(legalMoves.contains(move)) << fen << " " << static_cast<std::string>(move);
+        }
+        EXPECT_EQ(legalMoves.size(), filteredCount) << fen;
+    }
+}
+
+// Walks every node of a small tree and checks the staged modes against the full legal list
+static void checkStagedGeneration(Board& board, int depth) {
+    MoveGenerator moveGen(board);
+    const auto legal = moveGen.generateMoves();
+    const auto captures = moveGen.generate<GenType::Captures>();
+    const auto quiets = moveGen.generate<GenType::Quiets>();
+    const auto quietChecks = moveGen.generate<GenType::QuietChecks>();
+    const auto evasions = moveGen.generate<GenType::Evasions>();
+    const auto fen = board.toFEN();
+
+    // Captures and quiets partition the legal moves
+    EXPECT_EQ(captures.size() + quiets.size(), legal.size()) << fen;
+    for (const auto& move : captures) {
+        EXPECT_TRUE(legal.contains(move)) << fen << " " << static_cast<std::string>(move);
+        EXPECT_FALSE(quiets.contains(move)) << fen << " " << static_cast<std::string>(move);
+    }
+
+    const auto inCheck = board.isSquareAttacked(board.findKingSquare(board.side), !board.side);
+    EXPECT_EQ(evasions.size(), inCheck ? legal.size() : 0) << fen;
+
+    const auto movingSide = board.side;
+    std::size_t checkingQuiets = 0;
+    for (const auto& move : quiets) {
+        EXPECT_TRUE(legal.contains(move)) << fen << " " << static_cast<std::string>(move);
+        board.makeMove(move);
+        const auto givesCheck = board.isSquareAttacked(board.findKingSquare(board.side), movingSide);
+        board.unMakeMove(move);
+        if (!givesCheck) continue;
+        ++checkingQuiets;
+        EXPECT_TRUE(quietChecks.contains(move)) << fen << " " << static_cast<std::string>(move);
+    }
+    EXPECT_EQ(quietChecks.size(), checkingQuiets) << fen;
+
+    if (depth <= 1) return;
+    for (const auto& move : legal) {
+        board.makeMove(move);
+        checkStagedGeneration(board, depth - 1);
+        board.unMakeMove(move);
+    }
+}
+
+TEST(StagedGenerationTest, StagesMatchLegalMoves) {
+    for (const auto* fen :
+         {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+          "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+          "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+          "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8"}) {
+        Board board(fen);
+        checkStagedGeneration(board, 2);
+    }
+}
+
+TEST(StagedGenerationTest, QuietChecksIncludeDiscoveriesAndCastling) {
+    // Knight on E4 uncovers the rook on E1, the rook on A1 checks along the eighth rank
+    Board board("4k3/8/8/8/4N3/8/8/R3R1K1 w - - 0 1");
+    MoveGenerator moveGen(board);
+    const auto quietChecks = moveGen.generate<GenType::QuietChecks>();
+    EXPECT_TRUE(quietChecks.contains(Move(Square("E4").getIndex(), Square("C5").getIndex())));
+    EXPECT_TRUE(quietChecks.contains(Move(Square("A1").getIndex(), Square("A8").getIndex())));
+    EXPECT_FALSE(quietChecks.contains(Move(Square("G1").getIndex(), Square("G2").getIndex())));
+
+    // Castling long puts the rook on D1, facing the king
+    Board castling("3k4/8/8/8/8/8/8/R3K3 w Q - 0 1");
+    MoveGenerator castlingGen(castling);
+    EXPECT_TRUE(castlingGen.generate<GenType::QuietChecks>().contains(
+        Move(Square("E1").getIndex(), Square("C1").getIndex(), MoveFlag::CastleFlag)));
+}
+
+TEST(StagedGenerationTest, CapturesIncludeQuietPromotions) {
+    Board board("8/4P3/8/8/8/8/k7/4K3 w - - 0 1");
+    MoveGenerator moveGen(board);
+    EXPECT_EQ(moveGen.generate<GenType::Captures>().size(), 4);
+    EXPECT_EQ(moveGen.generate<GenType::Quiets>().size(), 5);
+}
+
+// Reference node counts from https://www.chessprogramming.org/Perft_Results
+TEST(PerftTest, StandardPositions) {
+    const std::vector<std::tuple<std::string, int, uint64_t>> positions = {
+        {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 3, 8902},
+        {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 3, 97862},
+        {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 4, 43238},
+        {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 3, 9467},
+        {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 3, 62379},
+    };
+    for (const auto& [fen, depth, expected] : positions) {
+        Board board(fen);
+        EXPECT_EQ(board.perft(depth), expected) << fen;
+        EXPECT_EQ(board.toFEN(), fen);
+    }
+}
+
+TEST(PerftTest, ParallelMatchesSerial) {
+    for (const auto* fen :
+         {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+          "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+          "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8"}) {
+        Board board(fen);
+        const auto serial = board.perft(4);
+        EXPECT_EQ(board.parallelPerft(4, 4), serial) << fen;
+        EXPECT_EQ(board.parallelPerft(1, 4), board.perft(1)) << fen;
+        EXPECT_EQ(board.toFEN(), fen);
+    }
+}
+
+TEST(PerftTest, BulkCountMatchesMakeUnmake) {
+    for (const auto* fen :
+         {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+          "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8"}) {
+        Board board(fen);
+        for (int depth = 1; depth <= 3; ++depth) {
+            EXPECT_EQ(board.perft(depth, false, Board::PerftMode::BulkCount),
+                      board.perft(depth, false, Board::PerftMode::MakeUnmake))
+                << fen << " depth " << depth;
+        }
+        EXPECT_EQ(board.toFEN(), fen);
+    }
+}
+
+TEST(PerftTest, CopyMakeMatchesMakeUnmake) {
+    for (const auto* fen :
+         {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+          "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"}) {
+        Board board(fen);
+        const auto key = board.zobristKey;
+        for (int depth = 1; depth <= 3; ++depth) {
+            EXPECT_EQ(board.perft(depth, false, Board::PerftMode::CopyMake),
+                      board.perft(depth, false, Board::PerftMode::MakeUnmake))
+                << fen << " depth " << depth;
+        }
+        EXPECT_EQ(board.toFEN(), fen);
+        EXPECT_EQ(board.zobristKey, key);
+        EXPECT_EQ(board.undoCount, 0u);
+    }
+}
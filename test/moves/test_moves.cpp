@@ -1,3 +1,4 @@
+#include "moves/move_list.hpp"
 #include "moves/moves.hpp"
 #include <gtest/gtest.h>
 
@@ -20,3 +21,34 @@ TEST(MoveTest, EnPassantMove) {
     Move move(32, 40, MoveFlag::EnPassantCaptureFlag); // A5 to A6, en passant
     EXPECT_TRUE(move.isEnPassant());
 }
+
+TEST(MoveListTest, PushAndIterate) {
+    MoveList moves;
+    EXPECT_TRUE(moves.empty());
+
+    moves.push_back(Move(12, 28, MoveFlag::PawnTwoUpFlag)); // E2E4
+    moves.emplace_back(6, 21);                              // G1F3
+    EXPECT_EQ(moves.size(), 2);
+    EXPECT_EQ(moves[0].getMoveFlag(), MoveFlag::PawnTwoUpFlag);
+    EXPECT_EQ(moves[1].targetSquareIndex(), 21);
+    EXPECT_TRUE(moves.contains(Move(6, 21)));
+    EXPECT_FALSE(moves.contains(Move(6, 23)));
+
+    int count = 0;
+    for (const auto& move : moves) {
+        EXPECT_FALSE(move.isNull());
+        ++count;
+    }
+    EXPECT_EQ(count, 2);
+
+    moves.clear();
+    EXPECT_TRUE(moves.empty());
+}
+
+TEST(MoveListTest, HoldsFullCapacity) {
+    MoveList moves;
+    for (std::size_t i = 0; i < MoveList::capacity; ++i) {
+        moves.emplace_back(static_cast<int>(i % 64), static_cast<int>((i + 1) % 64));
+    }
+    EXPECT_EQ(moves.size(), MoveList::capacity);
+}
@@ -0,0 +1,295 @@
+#include "board/board.hpp"
+#include "evaluation/evaluation.hpp"
+#include "moves/generation/move_generation.hpp"
+#include "moves/search/search.hpp"
+#include <array>
+#include <gtest/gtest.h>
+
+namespace {
+
+int staticScore(const Board& board) {
+    const auto score = Evaluation::evaluate(board);
+    return board.side == Side::White ? score : -score;
+}
+
+// The search's quiescence rules (stand pat, evasions in check, queen promotions, no captures that
+// lose material or cannot get near alpha), with plain fail-hard alpha-beta
+int quiescence(Board& board, int ply, int alpha, int beta) {
+    MoveGenerator generator(board);
+    const auto inCheck = board.isInCheck();
+    const auto moves =
+        inCheck ? generator.generateMoves() : generator.generate<GenType::Captures>();
+    if (inCheck && moves.empty()) return -Search::mateScore + ply;
+
+    const auto standPat = staticScore(board);
+    if (!inCheck) {
+        if (standPat >= beta) return beta;
+        alpha = std::max(alpha, standPat);
+    }
+    for (const auto& move : moves) {
+        if (!inCheck) {
+            const auto target = board.currentState.mailbox[move.targetSquareIndex()];
+            auto gain = target == BoardState::noPiece
+                            ? (move.isEnPassant() ? Evaluation::materialValues[0] : 0)
+                            : Evaluation::materialValues[target % 6];
+            if (move.isPromotion()) {
+                if (move.getPromotionPieceType() != PieceType::Queen) continue;
+                gain += Evaluation::materialValues[4] - Evaluation::materialValues[0];
+            }
+            if (standPat + gain + 200 <= alpha || !board.seeGE(move)) continue;
+        }
+        board.makeMove(move);
+        const auto score = -quiescence(board, ply + 1, -beta, -alpha);
+        board.unMakeMove(move);
+        if (score >= beta) return beta;
+        alpha = std::max(alpha, score);
+    }
+    return alpha;
+}
+
+// Plain alpha-beta in generation order with the search's leaf and mate scores, the reference for
+// the search with its move ordering and null windows
+int alphaBeta(Board& board, int depth, int ply, int alpha, int beta) {
+    if (depth == 0) return quiescence(board, ply, alpha, beta);
+    MoveGenerator generator(board);
+    const auto moves = generator.generateMoves();
+    if (moves.empty()) return board.isInCheck() ? -Search::mateScore + ply : 0;
+
+    for (const auto& move : moves) {
+        board.makeMove(move);
+        const auto score = -alphaBeta(board, depth - 1, ply + 1, -beta, -alpha);
+        board.unMakeMove(move);
+        if (score >= beta) return beta;
+        alpha = std::max(alpha, score);
+    }
+    return alpha;
+}
+
+} // namespace
+
+TEST(SearchTest, FindsMateInOne) {
+    Board board("6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1");
+    Search search(board);
+    const auto result = search.run({.depth = 4});
+
+    ASSERT_FALSE(result.pv.empty());
+    EXPECT_EQ(result.pv[0].value(), board.flaggedMove(Square("a1"), Square("a8")).value());
+    EXPECT_EQ(result.score, Search::mateScore - 1);
+    const auto info = Search::formatIteration(result);
+    EXPECT_NE(info.find("score mate 1 "), std::string::npos);
+    EXPECT_NE(info.find(" pv a1a8"), std::string::npos);
+}
+
+TEST(SearchTest, WinsHangingQueen) {
+    Board board("4k3/8/8/3q4/8/8/3R4/4K3 w - - 0 1");
+    Search search(board);
+    const auto result = search.run({.depth = 3});
+
+    ASSERT_FALSE(result.pv.empty());
+    EXPECT_EQ(result.pv[0].value(), board.flaggedMove(Square("d2"), Square("d5")).value());
+    EXPECT_GT(result.score, 400);
+}
+
+TEST(SearchTest, QuiescenceSeesRecapturesBeyondTheHorizon) {
+    // At depth 1 the pawn on d5 looks free; only the quiescence search sees c6xd5
+    Board board("4k3/8/2p5/3p4/8/8/3Q4/4K3 w - - 0 1");
+    const auto result = Search(board).run({.depth = 1});
+
+    ASSERT_FALSE(result.pv.empty());
+    EXPECT_NE(result.pv[0].value(), board.flaggedMove(Square("d2"), Square("d5")).value());
+    EXPECT_GT(result.qnodes, 0u);
+    EXPECT_LT(result.qnodes, result.nodes);
+
+    // A capture sequence the side to move can stop at any time: Rxd5 wins a pawn, Qxd5 would lose
+    // the queen to the rook behind the pawn
+    Board battery("3rk3/8/8/3p4/8/8/3R4/3QK3 w - - 0 1");
+    const auto won = Search(battery).run({.depth = 1});
+    ASSERT_FALSE(won.pv.empty());
+    EXPECT_EQ(won.pv[0].value(), battery.flaggedMove(Square("d2"), Square("d5")).value());
+}
+
+TEST(SearchTest, NoLegalMoves) {
+    Board stalemate("7k/5Q2/6K1/8/8/8/8/8 b - - 0 1");
+    const auto drawn = Search(stalemate).run({.depth = 5});
+    EXPECT_TRUE(drawn.pv.empty());
+    EXPECT_EQ(drawn.score, 0);
+
+    Board mated("R5k1/5ppp/8/8/8/8/8/6K1 b - - 0 1");
+    const auto lost = Search(mated).run({.depth = 5});
+    EXPECT_TRUE(lost.pv.empty());
+    EXPECT_EQ(lost.score, -Search::mateScore);
+    EXPECT_NE(Search::formatIteration(lost).find("score mate 0 "), std::string::npos);
+}
+
+TEST(SearchTest, ScoresDrawsAsZero) {
+    // Up a queen, but every move runs out the fifty move clock
+    Board fiftyMoves("4k3/8/8/8/8/8/8/Q3K3 w - - 99 80");
+    EXPECT_EQ(Search(fiftyMoves).run({.depth = 2}).score, 0);
+
+    // Three pawns down, black takes the repetition of the position the kings started from
+    Board repetition("k7/8/8/8/8/8/PPP5/1K6 w - - 0 1");
+    for (const auto& [from, to] : {std::pair{"b1", "a1"}, {"a8", "b8"}, {"a1", "b1"}}) {
+        repetition.makeMove(Square(from), Square(to));
+    }
+    const auto drawn = Search(repetition).run({.depth = 1});
+    EXPECT_EQ(drawn.score, 0);
+    EXPECT_EQ(drawn.pv[0].value(), repetition.flaggedMove(Square("b8"), Square("a8")).value());
+
+    // The same position without the history is simply lost
+    Board fresh(repetition.toFEN());
+    EXPECT_LT(Search(fresh).run({.depth = 1}).score, -200);
+}
+
+TEST(SearchTest, MatchesAlphaBeta) {
+    for (const auto* fen :
+         {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+          "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+          "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"}) {
+        Board board(fen);
+        for (int depth = 1; depth <= 3; ++depth) {
+            const auto result = Search(board).run({.depth = depth});
+            EXPECT_EQ(result.depth, depth) << fen;
+            EXPECT_EQ(result.score,
+                      alphaBeta(board, depth, 0, -Search::infinity, Search::infinity))
+                << fen << " depth " << depth;
+        }
+    }
+}
+
+TEST(SearchTest, ReportsEveryIterationAndRestoresTheBoard) {
+    Board board("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    const auto fen = board.toFEN();
+    const auto key = board.zobristKey;
+
+    std::vector<SearchIteration> iterations;
+    const auto result = Search(board).run(
+        {.depth = 4}, [&](const auto& iteration) { iterations.push_back(iteration); });
+
+    ASSERT_EQ(iterations.size(), 4u);
+    for (std::size_t i = 0; i < iterations.size(); ++i) {
+        EXPECT_EQ(iterations[i].depth, static_cast<int>(i) + 1);
+        EXPECT_FALSE(iterations[i].pv.empty());
+        if (i > 0) {
+            EXPECT_GT(iterations[i].nodes, iterations[i - 1].nodes);
+        }
+    }
+    EXPECT_EQ(result.depth, 4);
+    EXPECT_EQ(result.pv[0].value(), iterations.back().pv[0].value());
+    EXPECT_EQ(board.toFEN(), fen);
+    EXPECT_EQ(board.zobristKey, key);
+    EXPECT_EQ(board.undoCount, 0u);
+}
+
+TEST(SearchTest, StopsAtNodeLimit) {
+    Board board(Board::startPositionFen);
+    const auto result = Search(board).run({.depth = 64, .nodes = 20000});
+
+    EXPECT_GE(result.depth, 1);
+    EXPECT_LT(result.depth, 64);
+    EXPECT_LE(result.nodes, 20000u);
+    EXPECT_FALSE(result.pv.empty());
+}
+
+TEST(SearchTest, StopsAtTimeLimit) {
+    Board board("r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10");
+    const auto result = Search(board).run({.depth = 64, .time = std::chrono::milliseconds(50)});
+
+    EXPECT_LT(result.depth, 64);
+    EXPECT_LT(result.seconds, 1.0);
+    EXPECT_FALSE(result.pv.empty());
+}
+
+TEST(SearchTest, LazySmpHelpersShareTheTableAndStopWithTheMainThread) {
+    Board board("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    const auto fen = board.toFEN();
+    TranspositionTable table(16);
+
+    std::vector<SearchIteration> iterations;
+    const auto result = Search(board, &table, 4).run(
+        {.depth = 5}, [&](const auto& iteration) { iterations.push_back(iteration); });
+    EXPECT_EQ(result.depth, 5);
+    ASSERT_FALSE(result.pv.empty());
+    EXPECT_TRUE(board.generateLegalMoves().contains(result.pv[0]));
+    // Only the main thread reports, once per depth
+    ASSERT_EQ(iterations.size(), 5u);
+    EXPECT_EQ(iterations.back().depth, 5);
+    EXPECT_EQ(board.toFEN(), fen);
+
+    Board mate("k7/8/2K5/8/8/8/8/7R w - - 0 1");
+    table.clear();
+    EXPECT_EQ(Search(mate, &table, 4).run({.depth = 6}).score, Search::mateScore - 3);
+
+    // Limits stop the helpers as well, run() only returns once they are joined
+    Board middlegame("r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10");
+    const auto timed =
+        Search(middlegame, &table, 4).run({.depth = 64, .time = std::chrono::milliseconds(100)});
+    EXPECT_LT(timed.depth, 64);
+    EXPECT_LT(timed.seconds, 2.0);
+    EXPECT_FALSE(timed.pv.empty());
+
+    const auto counted = Search(middlegame, &table, 3).run({.depth = 64, .nodes = 50000});
+    EXPECT_LT(counted.depth, 64);
+    EXPECT_FALSE(counted.pv.empty());
+}
+
+namespace {
+
+const std::array<const char*, 3> splitPointPositions = {
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+};
+
+} // namespace
+
+TEST(SearchTest, SplitPointsFindTheSerialScore) {
+    // Without a table and without delta pruning alpha-beta's root score does not depend on the
+    // order the moves are searched in, so however the tasks interleave it is the serial one
+    for (const auto* fen : splitPointPositions) {
+        Board board(fen);
+        Search serialSearch(board);
+        serialSearch.setDeltaPruning(false);
+        const auto serial = serialSearch.run({.depth = 5});
+
+        Search splitSearch(board, nullptr, 4, ParallelMode::SplitPoints);
+        splitSearch.setDeltaPruning(false);
+        const auto split = splitSearch.run({.depth = 5});
+        EXPECT_EQ(split.score, serial.score) << fen;
+        EXPECT_EQ(split.depth, 5);
+        ASSERT_FALSE(split.pv.empty());
+        EXPECT_TRUE(board.generateLegalMoves().contains(split.pv[0]));
+        EXPECT_EQ(board.toFEN(), fen);
+    }
+
+    TranspositionTable table(16);
+    Board mate("k7/8/2K5/8/8/8/8/7R w - - 0 1");
+    EXPECT_EQ(Search(mate, &table, 4, ParallelMode::SplitPoints).run({.depth = 6}).score,
+              Search::mateScore - 3);
+}
+
+TEST(SearchTest, SplitPointsStayCloseToTheSerialScoreWithDeltaPruning) {
+    // Delta pruning depends on the window a node gets, which depends on how the tasks interleave
+    for (const auto* fen : splitPointPositions) {
+        Board board(fen);
+        const auto serial = Search(board).run({.depth = 5});
+        const auto split = Search(board, nullptr, 4, ParallelMode::SplitPoints).run({.depth = 5});
+        EXPECT_NEAR(split.score, serial.score, 50) << fen;
+        ASSERT_FALSE(split.pv.empty());
+        EXPECT_TRUE(board.generateLegalMoves().contains(split.pv[0]));
+    }
+}
+
+TEST(SearchTest, SplitPointsStopAtLimits) {
+    Board board("r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10");
+    TranspositionTable table(16);
+    const auto timed = Search(board, &table, 4, ParallelMode::SplitPoints)
+                           .run({.depth = 64, .time = std::chrono::milliseconds(100)});
+    EXPECT_LT(timed.depth, 64);
+    EXPECT_LT(timed.seconds, 2.0);
+    EXPECT_FALSE(timed.pv.empty());
+
+    const auto counted = Search(board, &table, 3, ParallelMode::SplitPoints)
+                             .run({.depth = 64, .nodes = 50000});
+    EXPECT_LT(counted.depth, 64);
+    EXPECT_FALSE(counted.pv.empty());
+}
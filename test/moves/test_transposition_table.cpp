@@ -0,0 +1,161 @@
+#include "board/board.hpp"
+#include "moves/search/search.hpp"
+#include "moves/search/transposition_table.hpp"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using Bound = TranspositionTable::Bound;
+
+TEST(TranspositionTableTest, StoreAndProbe) {
+    TranspositionTable table(1);
+    EXPECT_EQ(table.sizeInBytes(), 1024u * 1024u);
+
+    TranspositionTable::Entry entry;
+    EXPECT_FALSE(table.probe(0x1234, entry));
+
+    // Negative values survive the packing
+    table.store(0x1234, Move(12, 28), -250, -31, 7, Bound::Lower);
+    ASSERT_TRUE(table.probe(0x1234, entry));
+    EXPECT_EQ(entry.move.value(), Move(12, 28).value());
+    EXPECT_EQ(entry.score, -250);
+    EXPECT_EQ(entry.eval, -31);
+    EXPECT_EQ(entry.depth, 7);
+    EXPECT_EQ(entry.bound, Bound::Lower);
+
+    table.store(0x5678, Move(0), Search::mateScore - 3, TranspositionTable::noEval, -1,
+                Bound::Exact);
+    ASSERT_TRUE(table.probe(0x5678, entry));
+    EXPECT_TRUE(entry.move.isNull());
+    EXPECT_EQ(entry.score, Search::mateScore - 3);
+    EXPECT_EQ(entry.eval, TranspositionTable::noEval);
+    EXPECT_EQ(entry.depth, -1);
+
+    // Key 0 is not mistaken for an empty slot
+    EXPECT_FALSE(table.probe(0, entry));
+
+    table.clear();
+    EXPECT_FALSE(table.probe(0x1234, entry));
+}
+
+TEST(TranspositionTableTest, SamePositionKeepsDeepResultAndMove) {
+    TranspositionTable table(1);
+    TranspositionTable::Entry entry;
+
+    table.store(0x42, Move(12, 28), 30, 10, 8, Bound::Lower);
+    // Much shallower and not exact: ignored
+    table.store(0x42, Move(11, 27), 50, 10, 2, Bound::Upper);
+    ASSERT_TRUE(table.probe(0x42, entry));
+    EXPECT_EQ(entry.depth, 8);
+
+    // As deep, without a move: replaces the result but keeps the move
+    table.store(0x42, Move(0), 40, 10, 7, Bound::Upper);
+    ASSERT_TRUE(table.probe(0x42, entry));
+    EXPECT_EQ(entry.depth, 7);
+    EXPECT_EQ(entry.score, 40);
+    EXPECT_EQ(entry.move.value(), Move(12, 28).value());
+
+    // In a later search even a shallow result replaces it
+    table.newSearch();
+    table.store(0x42, Move(11, 27), 50, 10, 1, Bound::Upper);
+    ASSERT_TRUE(table.probe(0x42, entry));
+    EXPECT_EQ(entry.depth, 1);
+}
+
+TEST(TranspositionTableTest, FullBucketReplacesShallowestAndOldest) {
+    TranspositionTable table(1);
+    TranspositionTable::Entry entry;
+    // Keys differing only above the index bits share a bucket
+    const auto key = [](uint64_t n) { return n << 40 | 0x15; };
+
+    for (uint64_t n = 1; n <= 4; ++n) {
+        table.store(key(n), Move(0), 0, 0, 10 + static_cast<int>(n), Bound::Exact);
+    }
+    table.store(key(5), Move(0), 0, 0, 3, Bound::Exact);
+    EXPECT_FALSE(table.probe(key(1), entry)); // Depth 11 was the shallowest
+    for (uint64_t n = 2; n <= 5; ++n) EXPECT_TRUE(table.probe(key(n), entry)) << n;
+
+    // Two searches later a shallow current entry is worth more than a deep old one
+    table.clear();
+    for (uint64_t n = 1; n <= 3; ++n) {
+        table.store(key(n), Move(0), 0, 0, 10 + static_cast<int>(n), Bound::Exact);
+    }
+    table.newSearch();
+    table.newSearch();
+    table.store(key(4), Move(0), 0, 0, 2, Bound::Exact);
+    table.store(key(5), Move(0), 0, 0, 1, Bound::Exact);
+    EXPECT_FALSE(table.probe(key(1), entry));
+    for (uint64_t n = 2; n <= 5; ++n) EXPECT_TRUE(table.probe(key(n), entry)) << n;
+}
+
+TEST(TranspositionTableTest, Hashfull) {
+    TranspositionTable table(1);
+    EXPECT_EQ(table.hashfull(), 0);
+
+    // Fill every slot of the first 125 buckets, half of the sample
+    for (uint64_t bucket = 0; bucket < 125; ++bucket) {
+        for (uint64_t n = 1; n <= 4; ++n) {
+            table.store(n << 40 | bucket, Move(0), 0, 0, 5, Bound::Exact);
+        }
+    }
+    EXPECT_EQ(table.hashfull(), 500);
+
+    // Entries of earlier searches do not count
+    table.newSearch();
+    EXPECT_EQ(table.hashfull(), 0);
+}
+
+TEST(TranspositionTableTest, ConcurrentAccessNeverReturnsTornEntries) {
+    TranspositionTable table(1);
+    // Every writer derives the whole entry from the key, so a hit that mixes two writes shows up
+    // as a mismatch
+    const auto scoreFor = [](uint64_t key) { return static_cast<int>(key % 20000) - 10000; };
+    const auto depthFor = [](uint64_t key) { return static_cast<int>(key % 100); };
+
+    std::vector<std::thread> threads;
+    std::atomic<int> mismatches{0};
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            uint64_t state = 0x9E3779B97F4A7C15ULL * (t + 1);
+            for (int i = 0; i < 200000; ++i) {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                // Few distinct keys, so threads keep hitting the same slots
+                const auto key = (state % 4096) * 0x9E3779B97F4A7C15ULL;
+                TranspositionTable::Entry entry;
+                if (table.probe(key, entry)) {
+                    if (entry.score != scoreFor(key) || entry.depth != depthFor(key) ||
+                        entry.eval != -scoreFor(key)) {
+                        ++mismatches;
+                    }
+                } else {
+                    table.store(key, Move(static_cast<uint16_t>(key)), scoreFor(key),
+                                -scoreFor(key), depthFor(key), Bound::Exact);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    EXPECT_EQ(mismatches.load(), 0);
+}
+
+TEST(TranspositionTableTest, SearchWithTableFindsSameMateWithFewerNodes) {
+    Board board("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    const auto plain = Search(board).run({.depth = 5});
+
+    TranspositionTable table(16);
+    const auto hashed = Search(board, &table).run({.depth = 5});
+    EXPECT_EQ(hashed.depth, 5);
+    EXPECT_LT(hashed.nodes, plain.nodes);
+    EXPECT_GT(hashed.hashfull, 0);
+    EXPECT_EQ(plain.hashfull, -1);
+    EXPECT_NE(Search::formatIteration(hashed).find(" hashfull "), std::string::npos);
+
+    // Mate scores go through the table relative to the node they were found at
+    Board mate("k7/8/2K5/8/8/8/8/7R w - - 0 1");
+    table.clear();
+    const auto hashedMate = Search(mate, &table).run({.depth = 6});
+    EXPECT_EQ(hashedMate.score, Search(mate).run({.depth = 6}).score);
+    EXPECT_EQ(hashedMate.score, Search::mateScore - 3);
+}
@@ -0,0 +1,69 @@
+#include "threading/work_stealing_pool.hpp"
+#include <gtest/gtest.h>
+#include <numeric>
+
+TEST(WorkStealingPoolTest, RunsEveryTaskOnce) {
+    WorkStealingPool pool(4);
+    std::vector<int> results(1000, 0);
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        pool.submit([&results, i](std::size_t) { results[i] += static_cast<int>(i); });
+    }
+    pool.wait();
+    EXPECT_EQ(std::accumulate(results.begin(), results.end(), 0), 999 * 1000 / 2);
+}
+
+TEST(WorkStealingPoolTest, IdleWorkersStealFromBusyOnes) {
+    WorkStealingPool pool(4);
+    std::atomic<int> started{0};
+    std::vector<std::size_t> ranOn(64);
+    for (std::size_t i = 0; i < ranOn.size(); ++i) {
+        pool.submit([&, i](std::size_t worker) {
+            // The first task blocks its worker until the others have drained every queue
+            if (started.fetch_add(1) == 0) {
+                while (started.load() < static_cast<int>(ranOn.size())) std::this_thread::yield();
+            }
+            ranOn[i] = worker;
+        });
+    }
+    pool.wait();
+    EXPECT_EQ(started.load(), static_cast<int>(ranOn.size()));
+}
+
+TEST(WorkStealingPoolTest, CanBeReusedAfterWait) {
+    WorkStealingPool pool(2);
+    std::atomic<int> counter{0};
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 10; ++i) pool.submit([&](std::size_t) { ++counter; });
+        pool.wait();
+        EXPECT_EQ(counter.load(), 10 * (round + 1));
+    }
+}
+
+TEST(WorkStealingPoolTest, NestedTasksHelpWhileWaiting) {
+    // Every task splits into two that it waits for, deeper than there are workers: a task that
+    // blocked instead of running pending ones would leave none to run its children
+    WorkStealingPool pool(2);
+    std::atomic<int> leaves{0};
+    std::function<void(int, std::size_t)> split = [&](int depth, std::size_t worker) {
+        if (depth == 0) {
+            ++leaves;
+            return;
+        }
+        std::atomic<int> children{2};
+        for (int i = 0; i < 2; ++i) {
+            pool.submit(
+                [&, depth](std::size_t child) {
+                    split(depth - 1, child);
+                    --children;
+                },
+                worker);
+        }
+        while (children.load() > 0) {
+            if (!pool.runPendingTask(worker)) std::this_thread::yield();
+        }
+    };
+    pool.submit([&](std::size_t worker) { split(8, worker); });
+    pool.wait();
+    EXPECT_EQ(leaves.load(), 256);
+    EXPECT_FALSE(pool.runPendingTask(0));
+}